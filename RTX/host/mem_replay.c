@@ -0,0 +1,228 @@
+/**************************************************************************//**
+ * @file        mem_replay.c
+ * @brief       Replays allocation traces against the kernel memory manager
+ *              on a Linux host
+ *
+ * @note        A trace is a text file with one operation per line, '#'
+ *              starts a comment:
+ *                  a <id> <size>   k_mem_alloc(size), the block is named id
+ *                  f <id>          k_mem_dealloc of block id
+ *                  t <tid>         the following operations run as task tid
+ *              Every operation is timed with CLOCK_MONOTONIC. The heap is
+ *              sampled every -i operations, which gives fragmentation over
+ *              time. -g writes a synthetic trace instead of replaying one.
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#undef NULL
+#include "k_mem.h"
+
+#define MAX_IDS         (1 << 20)
+#define NSEC            1000000000ULL
+
+/* the kernel globals k_mem.c links against */
+unsigned int  g_host_ram_start;
+unsigned int  g_host_ram_end;
+unsigned int *g_host_image_end;
+TCB *gp_current_task;
+TCB g_tcbs[MAX_TASKS];
+RTX_SYS_INFO g_sys_info;
+
+typedef struct op_stats {
+    unsigned long long  count;
+    unsigned long long  total_ns;
+    unsigned long long  worst_ns;
+    unsigned long       worst_line;
+    unsigned long       fails;
+} op_stats;
+
+static void *blocks[MAX_IDS];
+
+static unsigned long long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSEC + ts.tv_nsec;
+}
+
+static void record(op_stats *st, unsigned long long ns, unsigned long line, int ok)
+{
+    st->count++;
+    st->total_ns += ns;
+    if (ns > st->worst_ns) {
+        st->worst_ns = ns;
+        st->worst_line = line;
+    }
+    st->fails += !ok;
+}
+
+static void sample(unsigned long ops)
+{
+    RTX_MEM_STATS st;
+
+    k_mem_stats(&st);
+    printf("%lu %u %u %u %u %d\n", ops, st.used, st.free_blks, st.largest_free,
+           st.heap_size - st.used, k_mem_count_extfrag(1024));
+}
+
+static void report(const char *name, op_stats *st)
+{
+    if (st->count == 0) {
+        return;
+    }
+    printf("# %-7s %llu ops, avg %llu ns, worst %llu ns (line %lu), %lu failed\n", name,
+           st->count, st->total_ns / st->count, st->worst_ns, st->worst_line, st->fails);
+}
+
+/* same mix as the T_09 trace: small messages, buffers and the odd stack */
+static void generate(unsigned long ops, unsigned long slots)
+{
+    unsigned char *live = calloc(slots, 1);
+
+    srand(4350);
+    printf("# synthetic trace, %lu ops over %lu live blocks\n", ops, slots);
+    for (unsigned long i = 0; i < ops; i++) {
+        unsigned long id = rand() % slots;
+        int r = rand() % 16;
+
+        if (live[id]) {
+            printf("f %lu\n", id);
+        } else if (r < 10) {
+            printf("a %lu %d\n", id, 8 + rand() % 120);
+        } else if (r < 15) {
+            printf("a %lu %d\n", id, 256 + rand() % 1792);
+        } else {
+            printf("a %lu %d\n", id, 4096 + rand() % 12288);
+        }
+        live[id] = !live[id];
+    }
+    free(live);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-a algo] [-s] [-m ram_mb] [-i interval] [trace]\n"
+            "       %s -g ops [-n live_blocks]\n"
+            "  -a  0 FIXED_POOL, 1 FIRST_FIT, 2 BEST_FIT, 3 WORST_FIT, 4 TLSF, 5 BUDDY\n"
+            "  -s  put the slab layer in front of the heap\n"
+            "  -m  simulated RAM in MB, default 64\n"
+            "  -i  sample the heap every interval ops, default 1000\n"
+            "  -g  write a synthetic trace of ops operations to stdout\n",
+            prog, prog);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    int algo = FIRST_FIT;
+    int slab = FALSE;
+    unsigned long ram_mb = 64;
+    unsigned long interval = 1000;
+    unsigned long gen_ops = 0;
+    unsigned long gen_slots = 4096;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "a:sm:i:g:n:")) != -1) {
+        switch (opt) {
+        case 'a': algo = atoi(optarg);               break;
+        case 's': slab = TRUE;                       break;
+        case 'm': ram_mb = strtoul(optarg, NULL, 0); break;
+        case 'i': interval = strtoul(optarg, NULL, 0); break;
+        case 'g': gen_ops = strtoul(optarg, NULL, 0); break;
+        case 'n': gen_slots = strtoul(optarg, NULL, 0); break;
+        default:  usage(argv[0]);
+        }
+    }
+    if (gen_ops != 0) {
+        generate(gen_ops, gen_slots);
+        return 0;
+    }
+
+    FILE *trace = (optind < argc) ? fopen(argv[optind], "r") : stdin;
+    if (trace == NULL) {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    size_t ram_size = ram_mb << 20;
+    unsigned char *ram = malloc(ram_size);
+    if (ram == NULL || interval == 0) {
+        usage(argv[0]);
+    }
+    g_host_image_end = (unsigned int *)ram;
+    g_host_ram_start = (unsigned int)ram;
+    g_host_ram_end = (unsigned int)ram + ram_size - 1;
+
+    if (k_mem_init_algo(algo) != RTX_OK || (slab && k_mem_slab_init() != RTX_OK)) {
+        fprintf(stderr, "k_mem init failed for algo %d\n", algo);
+        return 1;
+    }
+
+    op_stats alloc_st = {0};
+    op_stats free_st = {0};
+    unsigned long line = 0;
+    unsigned long ops = 0;
+    char buf[128];
+
+    printf("# algo %d%s, %lu MB RAM\n", algo, slab ? " + slab" : "", ram_mb);
+    printf("# op used free_blks largest_free free_bytes extfrag_1k\n");
+    while (fgets(buf, sizeof(buf), trace) != NULL) {
+        unsigned long id, arg = 0;
+        unsigned long long start, ns;
+        char cmd;
+
+        line++;
+        if (sscanf(buf, " %c %lu %lu", &cmd, &id, &arg) < 2 || cmd == '#') {
+            continue;
+        }
+        if (cmd != 't' && id >= MAX_IDS) {
+            fprintf(stderr, "line %lu: block id %lu out of range\n", line, id);
+            return 1;
+        }
+
+        switch (cmd) {
+        case 'a':
+            start = now_ns();
+            blocks[id] = k_mem_alloc(arg);
+            ns = now_ns() - start;
+            record(&alloc_st, ns, line, blocks[id] != NULL);
+            break;
+        case 'f':
+            start = now_ns();
+            int ret = k_mem_dealloc(blocks[id]);
+            ns = now_ns() - start;
+            record(&free_st, ns, line, ret == RTX_OK);
+            blocks[id] = NULL;
+            break;
+        case 't':
+            gp_current_task = (id < MAX_TASKS) ? &g_tcbs[id] : NULL;
+            if (gp_current_task != NULL) {
+                gp_current_task->tid = id;
+            }
+            continue;
+        default:
+            fprintf(stderr, "line %lu: unknown op '%c'\n", line, cmd);
+            return 1;
+        }
+
+        if (++ops % interval == 0) {
+            sample(ops);
+        }
+    }
+    sample(ops);
+
+    RTX_MEM_STATS st;
+    k_mem_stats(&st);
+    report("alloc", &alloc_st);
+    report("dealloc", &free_st);
+    printf("# peak used %u of %u bytes\n", st.peak_used, st.heap_size);
+    return 0;
+}
@@ -0,0 +1,189 @@
+/**************************************************************************//**
+ * @file        timer_bench.c
+ * @brief       Benchmarks the kernel timing wheel on a Linux host
+ *
+ * @note        Starts n timers with random expiry ticks, cancels a quarter
+ *              of them, re-arms half of the rest from their callback like
+ *              periodic releases do, and runs the wheel until every timer
+ *              has fired. Each timer checks that it fires on its own tick.
+ *              With -i the ticks without work are skipped the way the
+ *              tickless null task does, and the tick time is per wake-up.
+ *              The same inserts into a sorted delta list, the structure
+ *              the wheel replaced, are timed for comparison. Every
+ *              operation is timed with CLOCK_MONOTONIC.
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#undef NULL
+#include "k_timer.h"
+
+#define NSEC            1000000000ULL
+#define REARMS          4       /* periodic timers fire this many times */
+
+/* the kernel globals k_inc.h declares */
+unsigned int  g_host_ram_start;
+unsigned int  g_host_ram_end;
+unsigned int *g_host_image_end;
+
+typedef struct bench_timer {
+    KTIMER      timer;
+    U32         period;         /* 0 for one-shot timers */
+    int         fired;
+    struct bench_timer *next;   /* delta list of the baseline */
+    U32         delta;
+} bench_timer;
+
+static U32 g_now;
+static int g_idle;              /* skip the ticks with no work like the null task */
+static unsigned long g_fired;
+static unsigned long g_late;
+
+static unsigned long long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSEC + ts.tv_nsec;
+}
+
+static void fire(KTIMER *timer)
+{
+    bench_timer *bt = (bench_timer *)timer->arg;
+
+    g_fired++;
+    g_late += (timer->expires != g_now);
+    if (bt->period != 0 && ++bt->fired < REARMS) {
+        k_timer_start(timer, timer->expires + bt->period);
+    }
+}
+
+/* the sorted delta list of k_tsk_suspend before the wheel */
+static void delta_insert(bench_timer **head, bench_timer *bt, U32 ticks)
+{
+    bench_timer **link = head;
+
+    while (*link != NULL && (*link)->delta <= ticks) {
+        ticks -= (*link)->delta;
+        link = &(*link)->next;
+    }
+    bt->delta = ticks;
+    bt->next = *link;
+    if (bt->next != NULL) {
+        bt->next->delta -= ticks;
+    }
+    *link = bt;
+}
+
+static void bench(unsigned long n, U32 range)
+{
+    bench_timer *timers = calloc(n, sizeof(bench_timer));
+    U32 *expires = malloc(n * sizeof(U32));
+    unsigned long long start, start_ns, cancel_ns, run_ns, delta_ns;
+    unsigned long expected = 0;
+    unsigned long runs = 0;
+    U32 last = 0;
+
+    srand(4350);
+    for (unsigned long i = 0; i < n; i++) {
+        expires[i] = 1 + rand() % range;
+        timers[i].timer.fn = fire;
+        timers[i].timer.arg = &timers[i];
+        timers[i].period = (i % 2) ? 1 + rand() % (range / 8 + 1) : 0;
+    }
+
+    g_now = 0;
+    g_fired = 0;
+    g_late = 0;
+    k_timer_init(g_now);
+
+    start = now_ns();
+    for (unsigned long i = 0; i < n; i++) {
+        k_timer_start(&timers[i].timer, expires[i]);
+    }
+    start_ns = now_ns() - start;
+
+    start = now_ns();
+    for (unsigned long i = 0; i < n; i += 4) {
+        k_timer_cancel(&timers[i].timer);
+    }
+    cancel_ns = now_ns() - start;
+
+    for (unsigned long i = 0; i < n; i++) {
+        U32 fires = (i % 4 == 0) ? 0 : (timers[i].period != 0) ? REARMS : 1;
+        U32 end = expires[i] + (fires > 1 ? (fires - 1) * timers[i].period : 0);
+        expected += fires;
+        if (fires != 0 && end > last) {
+            last = end;
+        }
+    }
+
+    start = now_ns();
+    while (g_now < last) {
+        g_now += g_idle ? k_timer_next(last - g_now) : 1;
+        k_timer_run(g_now);
+        runs++;
+    }
+    run_ns = now_ns() - start;
+
+    bench_timer *head = NULL;
+    start = now_ns();
+    for (unsigned long i = 0; i < n; i++) {
+        delta_insert(&head, &timers[i], expires[i]);
+    }
+    delta_ns = now_ns() - start;
+
+    printf("%6lu timers over %u ticks: start %llu ns, cancel %llu ns, tick %llu ns, "
+           "delta list insert %llu ns\n", n, range, start_ns / n, cancel_ns / ((n + 3) / 4),
+           run_ns / runs, delta_ns / n);
+    if (g_idle) {
+        printf("       %lu wake-ups for %u ticks\n", runs, last);
+    }
+    if (g_fired != expected || g_late != 0) {
+        printf("       FAILED: %lu of %lu fired, %lu on the wrong tick\n", g_fired, expected, g_late);
+    }
+    free(timers);
+    free(expires);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-i] [-r range] [n ...]\n"
+            "  -i  jump over the ticks without work with k_timer_next\n"
+            "  -r  expiry ticks are spread over 1..range, default 100000\n"
+            "  n   timer counts to run, default 1000 4000 16000\n",
+            prog);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    U32 range = 100000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "ir:")) != -1) {
+        switch (opt) {
+        case 'i': g_idle = 1; break;
+        case 'r': range = strtoul(optarg, NULL, 0); break;
+        default:  usage(argv[0]);
+        }
+    }
+    if (range == 0) {
+        usage(argv[0]);
+    }
+
+    if (optind == argc) {
+        bench(1000, range);
+        bench(4000, range);
+        bench(16000, range);
+    }
+    for (int i = optind; i < argc; i++) {
+        bench(strtoul(argv[i], NULL, 0), range);
+    }
+    return 0;
+}
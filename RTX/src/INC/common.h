@@ -165,6 +165,7 @@ typedef struct rtx_sys_info {
     U32                 rtx_time_qtm;       /**< time granularity in microseconds  */
     POLLING_SERVER      server;             /**< scheduling server for non-real-time tasks */
     U8                  sched;              /**< scheduler                         */
+    U8                  mem_algo;           /**< heap policy k_mem_init lays out   */
 } RTX_SYS_INFO;
 
 /**
@@ -46,12 +46,28 @@
  *
  *****************************************************************************/
 
+#ifndef COMMON_EXT_H_
+#define COMMON_EXT_H_
+
 /*
  *===========================================================================
  *                             MACROS
  *===========================================================================
  */
 
+/* Memory Algorithms, continued from common.h */
+#define TLSF                4       /* two-level segregated fit, O(1) alloc and free */
+#define BUDDY               5       /* binary buddy system, O(log n) alloc and free */
+
+/* Memory Statistics */
+#define MEM_HIST_BUCKETS    32      /* one bucket per power of two of block size */
+#define SLAB_CLASSES        6       /* object sizes of the slab layer */
+#define SLAB_MAX_OBJ        64      /* larger requests bypass the slab layer */
+#define CACHE_LINE_SIZE     32      /* Cortex-A9 L1 line, for mem_alloc_aligned */
+
+/* Scheduling Statistics */
+#define SCHED_HIST_BUCKETS  32      /* one bucket per power of two of us */
+
 /*
  *===========================================================================
  *                             TYPEDEFS
@@ -64,6 +80,78 @@
  *                             STRUCTURES
  *===========================================================================
  */
+
+/**
+ * @brief free heap blocks by size, bucket i counts blocks of 2^i to 2^(i+1)-1 bytes
+ */
+typedef struct rtx_mem_hist {
+    U32                 free_blks[MEM_HIST_BUCKETS];    /**< free blocks per bucket    */
+} RTX_MEM_HIST;
+
+/**
+ * @brief heap usage counters, all kept incrementally by k_mem_alloc and k_mem_dealloc
+ */
+typedef struct rtx_mem_stats {
+    U32                 heap_size;          /**< bytes managed by the heap         */
+    U32                 used;               /**< bytes in allocated blocks, headers included */
+    U32                 peak_used;          /**< high-water mark of used           */
+    U32                 largest_free;       /**< size of the largest free block    */
+    U32                 free_blks;          /**< number of free fragments          */
+    U32                 num_allocs;         /**< successful allocations            */
+    U32                 num_frees;          /**< successful deallocations          */
+    U32                 num_alloc_fails;    /**< allocations that returned NULL    */
+    U32                 num_free_fails;     /**< deallocations that returned RTX_ERR */
+    U32                 num_realloc_in_place; /**< reallocations that kept the block */
+    U32                 num_realloc_copies; /**< reallocations that had to move the data */
+    U32                 stack_size;         /**< bytes in the task stack region    */
+    U32                 stack_used;         /**< bytes in live stacks of the region */
+    U32                 stack_peak_used;    /**< high-water mark of stack_used     */
+    U32                 stack_spills;       /**< stacks that had to come from the heap */
+} RTX_MEM_STATS;
+
+/**
+ * @brief slab layer occupancy, one entry per object size class
+ */
+typedef struct rtx_slab_stats {
+    U32                 obj_size[SLAB_CLASSES]; /**< object size in bytes          */
+    U32                 capacity[SLAB_CLASSES]; /**< objects per slab page         */
+    U32                 pages[SLAB_CLASSES];    /**< pages held by the class       */
+    U32                 in_use[SLAB_CLASSES];   /**< objects handed out            */
+} RTX_SLAB_STATS;
+
+/**
+ * @brief deepest stack use of a task, needs MEM_STK_PAINT
+ */
+typedef struct rtx_stk_usage {
+    U32                 k_stack_size;       /**< kernel stack size in bytes        */
+    U32                 k_stack_used;       /**< deepest kernel stack use in bytes */
+    U32                 u_stack_size;       /**< user stack size, 0 for privileged tasks */
+    U32                 u_stack_used;       /**< deepest user stack use in bytes   */
+} RTX_STK_USAGE;
+
+/**
+ * @brief job timing of a real-time task, times are A9 private timer counts
+ *        in us, the timer counts down so a later time is a smaller count
+ */
+typedef struct rtx_rt_stats {
+    U32                 jobs;               /**< jobs completed with tsk_done_rt   */
+    U32                 misses;             /**< jobs completed after their deadline */
+    U32                 max_response;       /**< longest release to completion in us */
+    U32                 max_jitter;         /**< longest release to first dispatch in us */
+    U32                 release;            /**< release of the current job        */
+    U32                 start;              /**< first dispatch of the current job, 0 before it */
+    U32                 finish;             /**< completion of the last job        */
+    U32                 deadline;           /**< deadline of the current job       */
+} RTX_RT_STATS;
+
+/**
+ * @brief scheduling latency of one priority level, needs SCHED_HIST, bucket 0
+ *        counts times under 1 us and bucket i > 0 times of 2^(i-1) to 2^i-1 us
+ */
+typedef struct rtx_sched_hist {
+    U32                 wake_lat[SCHED_HIST_BUCKETS];   /**< ready to first dispatch */
+    U32                 switch_cost[SCHED_HIST_BUCKETS];/**< k_tsk_switch to running on the new stack */
+} RTX_SCHED_HIST;
  
 
 
@@ -73,6 +161,7 @@
   *===========================================================================
   */
 
+#endif // ! COMMON_EXT_H_
 
  /*
   *===========================================================================
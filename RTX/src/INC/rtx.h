@@ -77,10 +77,38 @@ extern int k_mem_dealloc(void *);
 #define mem_dealloc(ptr) _mem_dealloc((U32)k_mem_dealloc, ptr)
 extern int _mem_dealloc(U32 p_func, void *ptr) __SVC_0;
 
+extern void *k_mem_alloc_aligned(size_t size, size_t align);
+#define mem_alloc_aligned(size, align) _mem_alloc_aligned((U32)k_mem_alloc_aligned, size, align)
+extern void *_mem_alloc_aligned(U32 p_func, size_t size, size_t align) __SVC_0;
+
+extern void *k_mem_realloc(void *ptr, size_t size);
+#define mem_realloc(ptr, size) _mem_realloc((U32)k_mem_realloc, ptr, size)
+extern void *_mem_realloc(U32 p_func, void *ptr, size_t size) __SVC_0;
+
 extern int k_mem_count_extfrag(size_t size);
 #define mem_count_extfrag(size) _mem_count_extfrag((U32)k_mem_count_extfrag, size)
 extern int _mem_count_extfrag(U32 p_func, size_t size) __SVC_0;
 
+extern int k_mem_stats(RTX_MEM_STATS *buffer);
+#define mem_stats(buffer) _mem_stats((U32)k_mem_stats, buffer)
+extern int _mem_stats(U32 p_func, RTX_MEM_STATS *buffer) __SVC_0;
+
+extern int k_mem_count_intfrag(void);
+#define mem_count_intfrag() _mem_count_intfrag((U32)k_mem_count_intfrag)
+extern int _mem_count_intfrag(U32 p_func) __SVC_0;
+
+extern int k_mem_get_stats(RTX_MEM_HIST *buffer);
+#define mem_get_stats(buffer) _mem_get_stats((U32)k_mem_get_stats, buffer)
+extern int _mem_get_stats(U32 p_func, RTX_MEM_HIST *buffer) __SVC_0;
+
+extern int k_mem_slab_stats(RTX_SLAB_STATS *buffer);
+#define mem_slab_stats(buffer) _mem_slab_stats((U32)k_mem_slab_stats, buffer)
+extern int _mem_slab_stats(U32 p_func, RTX_SLAB_STATS *buffer) __SVC_0;
+
+extern int k_mem_arena_create(size_t size);
+#define mem_arena_create(size) _mem_arena_create((U32)k_mem_arena_create, size)
+extern int _mem_arena_create(U32 p_func, size_t size) __SVC_0;
+
 /*------------------------------------------------------------------------*
  * System Initialization Function(s) - LAB2, LAB4, LAB5
  *------------------------------------------------------------------------*/
@@ -127,6 +155,10 @@ extern task_t k_tsk_get_tid(void);
 #define tsk_get_tid() _tsk_get_tid((U32)k_tsk_get_tid)
 extern task_t __SVC_0 _tsk_get_tid(U32 p_func);
 
+extern int k_tsk_get_stack_usage(task_t task_id, RTX_STK_USAGE *buffer);
+#define tsk_get_stack_usage(task_id, buffer) _tsk_get_stack_usage((U32)k_tsk_get_stack_usage, task_id, buffer)
+extern int __SVC_0 _tsk_get_stack_usage(U32 p_func, task_t task_id, RTX_STK_USAGE *buffer);
+
 extern int k_tsk_ls(task_t *buf, int count);
 #define tsk_ls(buf, count) _tsk_ls((U32)k_tsk_ls, buf, count);
 extern int __SVC_0 _tsk_ls(U32 p_func, task_t *buf, int count);
@@ -139,10 +171,22 @@ extern int k_tsk_create_rt(task_t *tid, TASK_RT *task);
 #define tsk_create_rt(tid, task) _tsk_create_rt((U32)k_tsk_create_rt, tid, task)
 extern int __SVC_0 _tsk_create_rt(U32 p_func, task_t *tid, TASK_RT *task);
 
+extern int k_tsk_create_rt_wcet(task_t *tid, TASK_RT *task, TIMEVAL *c_n);
+#define tsk_create_rt_wcet(tid, task, c_n) _tsk_create_rt_wcet((U32)k_tsk_create_rt_wcet, tid, task, c_n)
+extern int __SVC_0 _tsk_create_rt_wcet(U32 p_func, task_t *tid, TASK_RT *task, TIMEVAL *c_n);
+
 extern void k_tsk_done_rt(void);
 #define tsk_done_rt() _tsk_done_rt((U32)k_tsk_done_rt)
 extern void __SVC_0 _tsk_done_rt(U32 p_func);
 
+extern int k_tsk_get_rt_stats(task_t task_id, RTX_RT_STATS *buffer);
+#define tsk_get_rt_stats(task_id, buffer) _tsk_get_rt_stats((U32)k_tsk_get_rt_stats, task_id, buffer)
+extern int __SVC_0 _tsk_get_rt_stats(U32 p_func, task_t task_id, RTX_RT_STATS *buffer);
+
+extern int k_tsk_get_sched_hist(U8 prio, RTX_SCHED_HIST *buffer);
+#define tsk_get_sched_hist(prio, buffer) _tsk_get_sched_hist((U32)k_tsk_get_sched_hist, prio, buffer)
+extern int __SVC_0 _tsk_get_sched_hist(U32 p_func, U8 prio, RTX_SCHED_HIST *buffer);
+
 extern void k_tsk_suspend(TIMEVAL *tv);
 #define tsk_suspend(tv) _tsk_suspend((U32) k_tsk_suspend, tv)
 extern void __SVC_0 _tsk_suspend(U32 p_func, TIMEVAL *tv);
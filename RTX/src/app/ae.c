@@ -59,10 +59,42 @@ int ae_set_sys_info(RTX_SYS_INFO *sys_info) {
 
     // Scheduling sys info set up, only do DEFAULT in lab2
     sys_info->sched = DEFAULT;
+    sys_info->rtx_time_qtm = MIN_RTX_QTM;
+    sys_info->mem_algo = FIRST_FIT;
+#if TEST == 12
+    sys_info->sched = EDF;
+#endif
+#if TEST == 13
+    // 4 ms of every 20 ms for the non real-time tasks
+    sys_info->sched = RM_PS;
+    sys_info->server.p_n.sec = 0;
+    sys_info->server.p_n.usec = 20000;
+    sys_info->server.b_n.sec = 0;
+    sys_info->server.b_n.usec = 4000;
+#endif
+#if TEST == 14
+    sys_info->sched = RM_NPS;
+#endif
 
     return RTX_OK;
 }
 
+/**************************************************************************//**
+ * @brief       set up an unprivileged boot task with the default stack sizes
+ * @param[out]  task    the RTX_TASK_INFO element to write to
+ * @param[in]   ptask   entry point of the task
+ * @param[in]   prio    priority of the task
+ * @return      None
+ *****************************************************************************/
+
+void ae_set_utask(RTX_TASK_INFO *task, void (*ptask)(void), U8 prio) {
+    task->prio = prio;
+	task->priv = 0;
+	task->ptask = ptask;
+	task->k_stack_size = 0x200;
+	task->u_stack_size = 0x200;
+}
+
 /**************************************************************************//**
  * @brief       fill the tasks array with information
  * @param[out]  tasks 		An array of RTX_TASK_INFO elements to write to
@@ -266,6 +298,89 @@ void ae_set_task_info(RTX_TASK_INFO *tasks, int num_tasks) {
 
 #endif
 
+#if TEST == 9
+
+    printf("============================================\r\n");
+    printf("============================================\r\n");
+    printf("Info: Starting T_09 memory benchmarks!\r\n");
+    printf("Info: The benchmarks run before the RTX starts, then KCD and the stack and arena checks boot!\r\n");
+
+    tasks[0].prio = HIGH;
+	tasks[0].priv = 0;
+	tasks[0].ptask = &kcd_task;
+	tasks[0].k_stack_size = 0x200;
+	tasks[0].u_stack_size = 0x200;
+
+    tasks[1].prio = MEDIUM;
+	tasks[1].priv = 0;
+	tasks[1].ptask = &utask1;
+	tasks[1].k_stack_size = 0x200;
+	tasks[1].u_stack_size = 0x800;
+
+#endif
+
+#if TEST == 10
+
+    printf("============================================\r\n");
+    printf("============================================\r\n");
+    printf("Info: Starting T_10 context switch benchmark!\r\n");
+
+    ae_set_utask(&tasks[0], &utask1, MEDIUM);
+
+#endif
+
+#if TEST == 11
+
+    printf("============================================\r\n");
+    printf("============================================\r\n");
+    printf("Info: Starting T_11 round-robin preemption!\r\n");
+
+    ae_set_utask(&tasks[0], &utask1, MEDIUM);
+    ae_set_utask(&tasks[1], &utask2, MEDIUM);
+
+#endif
+
+#if TEST == 12
+
+    printf("============================================\r\n");
+    printf("============================================\r\n");
+    printf("Info: Starting T_12 EDF deadline miss benchmark!\r\n");
+
+    ae_set_utask(&tasks[0], &utask1, MEDIUM);
+
+#endif
+
+#if TEST == 13
+
+    printf("============================================\r\n");
+    printf("============================================\r\n");
+    printf("Info: Starting T_13 RM polling server!\r\n");
+
+    ae_set_utask(&tasks[0], &utask1, MEDIUM);
+
+#endif
+
+#if TEST == 14
+
+    printf("============================================\r\n");
+    printf("============================================\r\n");
+    printf("Info: Starting T_14 RM_NPS admission test!\r\n");
+
+    ae_set_utask(&tasks[0], &utask1, MEDIUM);
+
+#endif
+
+#if TEST == 15
+
+    printf("============================================\r\n");
+    printf("============================================\r\n");
+    printf("Info: Starting T_15 tsk_suspend!\r\n");
+
+    ae_set_utask(&tasks[0], &utask1, MEDIUM);
+    ae_set_utask(&tasks[1], &utask2, LOW);
+
+#endif
+
 
 }
 
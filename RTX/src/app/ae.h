@@ -88,6 +88,34 @@ extern task_t ktid3;
 	#define BOOT_TASKS 2
 #endif
 
+#if TEST == 9
+	#define BOOT_TASKS 2
+#endif
+
+#if TEST == 10
+	#define BOOT_TASKS 1
+#endif
+
+#if TEST == 11
+	#define BOOT_TASKS 2
+#endif
+
+#if TEST == 12
+	#define BOOT_TASKS 1
+#endif
+
+#if TEST == 13
+	#define BOOT_TASKS 1
+#endif
+
+#if TEST == 14
+	#define BOOT_TASKS 1
+#endif
+
+#if TEST == 15
+	#define BOOT_TASKS 2
+#endif
+
 /*
  *===========================================================================
  *                            FUNCTION PROTOTYPES
@@ -98,6 +126,7 @@ int  ae_init          (RTX_SYS_INFO *sys_info, \
                        RTX_TASK_INFO *task_info, int num_tasks);
 int  ae_set_sys_info  (RTX_SYS_INFO *sys_info);
 void ae_set_task_info (RTX_TASK_INFO *tasks, int num_tasks);
+void ae_set_utask     (RTX_TASK_INFO *task, void (*ptask)(void), U8 prio);
 int  ae_start(void);
 
 int  test_mem(void);
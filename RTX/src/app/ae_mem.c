@@ -40,6 +40,7 @@
 #include "Serial.h"
 #include "printf.h"
 #include "ae.h"
+#include "k_mem.h"
 
 #if TEST == -1
 
@@ -236,6 +237,326 @@ int test_mem(void) {
 }
 #endif
 
+#if TEST == 9
+
+/*
+ * Worst-case latency of k_mem_alloc/k_mem_dealloc on a fragmented heap.
+ * Every other block of a long run is freed, leaving hundreds of small holes.
+ * The large requests fit none of them, so a list walk has to visit them all.
+ * Times are A9 private timer ticks at 200 MHz (5 ns).
+ */
+
+#define BENCH_BLOCKS 1000
+#define BENCH_ROUNDS 200
+
+static void *bench_ptr[BENCH_BLOCKS];
+static unsigned int bench_seed;
+
+static unsigned int bench_rand(void) {
+	bench_seed = bench_seed * 1103515245 + 12345;
+	return bench_seed >> 16;
+}
+
+static void bench_latency(int algo, char *name) {
+	unsigned int alloc_max = 0, alloc_sum = 0;
+	unsigned int free_max = 0, free_sum = 0;
+	unsigned int start, ticks;
+
+	k_mem_init_algo(algo);
+	bench_seed = 350;
+
+	for (int i = 0; i < BENCH_BLOCKS; i++) {
+		bench_ptr[i] = k_mem_alloc(16 + bench_rand() % 240);
+	}
+	for (int i = 1; i < BENCH_BLOCKS; i += 2) {
+		k_mem_dealloc(bench_ptr[i]);
+	}
+
+	for (int i = 0; i < BENCH_ROUNDS; i++) {
+		size_t size = (i & 1) ? 1024 + bench_rand() % 1024 : 16 + bench_rand() % 240;
+
+		start = timer_get_current_val(2);
+		void *p = k_mem_alloc(size);
+		ticks = start - timer_get_current_val(2);	// timer counts down
+		alloc_sum += ticks;
+		alloc_max = (ticks > alloc_max) ? ticks : alloc_max;
+
+		start = timer_get_current_val(2);
+		k_mem_dealloc(p);
+		ticks = start - timer_get_current_val(2);
+		free_sum += ticks;
+		free_max = (ticks > free_max) ? ticks : free_max;
+	}
+
+	printf("%s: alloc avg %u max %u, dealloc avg %u max %u ticks\r\n", name,
+			alloc_sum / BENCH_ROUNDS, alloc_max, free_sum / BENCH_ROUNDS, free_max);
+}
+
+/*
+ * Fragmentation of each policy on the same allocation trace. The trace is a
+ * fixed sequence of allocs and frees over TRACE_SLOTS live objects with mixed
+ * sizes and lifetimes, so every policy sees exactly the same requests.
+ */
+
+#define TRACE_OPS   4000
+#define TRACE_SLOTS 256
+
+static unsigned short trace_size[TRACE_OPS];	// 0 frees the slot
+static unsigned char trace_slot[TRACE_OPS];
+static void *trace_ptr[TRACE_SLOTS];
+
+static void trace_build(void) {
+	unsigned char live[TRACE_SLOTS] = {0};
+
+	bench_seed = 4350;
+	for (int i = 0; i < TRACE_OPS; i++) {
+		int slot = bench_rand() % TRACE_SLOTS;
+		unsigned int r = bench_rand() % 16;
+
+		trace_slot[i] = slot;
+		if (live[slot]) {
+			trace_size[i] = 0;
+		} else if (r < 10) {
+			trace_size[i] = 8 + bench_rand() % 120;		// messages and list nodes
+		} else if (r < 15) {
+			trace_size[i] = 256 + bench_rand() % 1792;	// buffers
+		} else {
+			trace_size[i] = 4096 + bench_rand() % 12288;	// stacks
+		}
+		live[slot] = !live[slot];
+	}
+}
+
+static void bench_trace(int algo, char *name) {
+	unsigned int alloc_sum = 0, free_sum = 0;
+	unsigned int num_alloc = 0, num_free = 0;
+	unsigned int start;
+
+	k_mem_init_algo(algo);
+	for (int i = 0; i < TRACE_SLOTS; i++) {
+		trace_ptr[i] = NULL;
+	}
+
+	for (int i = 0; i < TRACE_OPS; i++) {
+		int slot = trace_slot[i];
+
+		if (trace_size[i] == 0) {
+			start = timer_get_current_val(2);
+			k_mem_dealloc(trace_ptr[slot]);
+			free_sum += start - timer_get_current_val(2);
+			num_free++;
+			trace_ptr[slot] = NULL;
+		} else {
+			start = timer_get_current_val(2);
+			trace_ptr[slot] = k_mem_alloc(trace_size[i]);
+			alloc_sum += start - timer_get_current_val(2);
+			num_alloc++;
+		}
+	}
+
+	printf("%s: extfrag 64B %d, 1KB %d, 16KB %d, alloc avg %u, dealloc avg %u ticks\r\n",
+			name, k_mem_count_extfrag(64), k_mem_count_extfrag(1024), k_mem_count_extfrag(16384),
+			alloc_sum / num_alloc, free_sum / num_free);
+	if (algo == BUDDY) {
+		printf("%s: %d bytes lost to rounding inside allocated blocks\r\n", name, k_mem_count_intfrag());
+	}
+}
+
+/*
+ * Small kernel objects with and without the slab layer: TID nodes (8 B),
+ * KEY_IN messages (9 B) and KCD command messages (up to 64 B). The heap is
+ * first riddled with holes of 16 to 48 bytes, as left behind by small object
+ * churn, so without the slab layer the larger messages search past them all.
+ */
+
+#define SMALL_BATCH 96
+
+static void bench_small(int slab, char *name) {
+	static const size_t sizes[3] = { 8, 9, 64 };
+	unsigned int alloc_sum = 0, free_sum = 0;
+	unsigned int start;
+	void *objs[SMALL_BATCH];
+
+	k_mem_init_algo(FIRST_FIT);
+	bench_seed = 350;
+	for (int i = 0; i < BENCH_BLOCKS; i++) {
+		bench_ptr[i] = k_mem_alloc(8 + bench_rand() % 32);
+	}
+	for (int i = 1; i < BENCH_BLOCKS; i += 2) {
+		k_mem_dealloc(bench_ptr[i]);
+	}
+	if (slab) {
+		k_mem_slab_init();
+	}
+
+	for (int round = 0; round < BENCH_ROUNDS / 10; round++) {
+		for (int i = 0; i < SMALL_BATCH; i++) {
+			start = timer_get_current_val(2);
+			objs[i] = k_mem_alloc(sizes[i % 3]);
+			alloc_sum += start - timer_get_current_val(2);
+		}
+		for (int i = 0; i < SMALL_BATCH; i++) {
+			start = timer_get_current_val(2);
+			k_mem_dealloc(objs[i]);
+			free_sum += start - timer_get_current_val(2);
+		}
+	}
+
+	printf("%s: small alloc avg %u, dealloc avg %u ticks\r\n", name,
+			alloc_sum / (BENCH_ROUNDS / 10 * SMALL_BATCH), free_sum / (BENCH_ROUNDS / 10 * SMALL_BATCH));
+}
+
+/*
+ * A buffer grown GROW_STEP bytes at a time, as KCD does when it accumulates
+ * a command, once with alloc, copy and free and once with k_mem_realloc.
+ * Every fourth step a short message is allocated right behind the buffer
+ * and freed one step later, so some of the grows cannot happen in place.
+ */
+
+#define GROW_STEP   16
+#define GROW_MAX    1024
+
+static unsigned int bench_grow(int use_realloc) {
+	unsigned int ticks = 0;
+	unsigned int start;
+	unsigned char *buf = k_mem_alloc(GROW_STEP);
+	void *msg = NULL;
+
+	for (size_t size = 2 * GROW_STEP; size <= GROW_MAX; size += GROW_STEP) {
+		start = timer_get_current_val(2);
+		if (use_realloc) {
+			buf = k_mem_realloc(buf, size);
+		} else {
+			unsigned char *bigger = k_mem_alloc(size);
+			for (size_t i = 0; i < size - GROW_STEP; i++) {
+				bigger[i] = buf[i];
+			}
+			k_mem_dealloc(buf);
+			buf = bigger;
+		}
+		ticks += start - timer_get_current_val(2);
+
+		if (msg != NULL) {
+			k_mem_dealloc(msg);
+			msg = NULL;
+		}
+		if ((size / GROW_STEP) % 4 == 0) {
+			msg = k_mem_alloc(24);
+		}
+	}
+	k_mem_dealloc(msg);
+	k_mem_dealloc(buf);
+	return ticks;
+}
+
+static void bench_realloc(int algo, char *name) {
+	unsigned int copy_ticks = 0, realloc_ticks = 0;
+	RTX_MEM_STATS st;
+
+	k_mem_init_algo(algo);
+	for (int round = 0; round < BENCH_ROUNDS / 10; round++) {
+		copy_ticks += bench_grow(FALSE);
+	}
+	for (int round = 0; round < BENCH_ROUNDS / 10; round++) {
+		realloc_ticks += bench_grow(TRUE);
+	}
+	k_mem_stats(&st);
+
+	printf("%s: grow to %u B, alloc+copy %u, realloc %u ticks, %u in place, %u copied\r\n",
+			name, GROW_MAX, copy_ticks / (BENCH_ROUNDS / 10), realloc_ticks / (BENCH_ROUNDS / 10),
+			st.num_realloc_in_place, st.num_realloc_copies);
+}
+
+/*
+ * mem_alloc_aligned: the payload starts on the boundary asked for, keeps
+ * its contents and its alignment through a realloc, which a block right
+ * behind it makes move, and frees back to where it came from.
+ * Under FIXED_POOL a KCD mailbox comes from its pool, so the heap behind
+ * the pools keeps its largest free block.
+ */
+
+#define ALIGN_BYTES 100
+
+static int test_aligned(int algo, char *name) {
+	static const size_t aligns[3] = { 32, 64, 256 };
+	RTX_MEM_STATS before, after;
+	int passed = TRUE;
+
+	k_mem_init_algo(algo);
+	k_mem_stats(&before);
+	for (int i = 0; i < 3; i++) {
+		U8 *p = k_mem_alloc_aligned(ALIGN_BYTES, aligns[i]);
+		if (p == NULL || ((U32)p & (aligns[i] - 1))) {
+			passed = FALSE;
+			continue;
+		}
+		for (int j = 0; j < ALIGN_BYTES; j++) {
+			p[j] = (U8)(i + j);
+		}
+		void *behind = k_mem_alloc(ALIGN_BYTES);
+		U8 *q = k_mem_realloc(p, 16 * ALIGN_BYTES);
+		if (q == NULL || ((U32)q & (aligns[i] - 1))) {
+			k_mem_dealloc((q == NULL) ? p : q);
+			k_mem_dealloc(behind);
+			passed = FALSE;
+			continue;
+		}
+		for (int j = 0; j < ALIGN_BYTES; j++) {
+			passed = passed && (q[j] == (U8)(i + j));
+		}
+		passed = passed && (k_mem_dealloc(q) == RTX_OK) && (k_mem_dealloc(behind) == RTX_OK);
+	}
+
+	void *mbx = k_mem_alloc_aligned(KCD_MBX_SIZE, CACHE_LINE_SIZE);
+	k_mem_stats(&after);
+	if (mbx == NULL || ((U32)mbx & (CACHE_LINE_SIZE - 1)) ||
+	    (algo == FIXED_POOL && after.largest_free != before.largest_free)) {
+		passed = FALSE;
+	}
+	passed = passed && (k_mem_dealloc(mbx) == RTX_OK);
+	k_mem_stats(&after);
+	passed = passed && (after.used == before.used);
+	// a pointer that was never allocated is refused, and is no allocation failure
+	passed = passed && (k_mem_realloc((U8 *)mbx + 8, 16) == NULL);
+	k_mem_stats(&after);
+	passed = passed && (after.num_alloc_fails == before.num_alloc_fails);
+
+	printf("%s: aligned alloc, realloc and free %s\r\n", name, passed ? "passed" : "FAILED");
+	return passed;
+}
+
+int test_mem(void) {
+	// 5 ns resolution for the benchmark, k_rtx_init sets the 1 us tick back
+	config_a9_timer(0xFFFFFFFF, 1, 0, 0);
+
+	bench_latency(FIXED_POOL, "FIXED_POOL");
+	bench_latency(FIRST_FIT, "FIRST_FIT");
+	bench_latency(BEST_FIT, "BEST_FIT");
+	bench_latency(WORST_FIT, "WORST_FIT");
+	bench_latency(TLSF, "TLSF");
+	bench_latency(BUDDY, "BUDDY");
+
+	bench_small(FALSE, "FIRST_FIT");
+	bench_small(TRUE, "FIRST_FIT+SLAB");
+
+	trace_build();
+	bench_trace(FIRST_FIT, "FIRST_FIT");
+	bench_trace(BEST_FIT, "BEST_FIT");
+	bench_trace(WORST_FIT, "WORST_FIT");
+	bench_trace(TLSF, "TLSF");
+	bench_trace(BUDDY, "BUDDY");
+
+	bench_realloc(FIRST_FIT, "FIRST_FIT");
+	bench_realloc(TLSF, "TLSF");
+	bench_realloc(BUDDY, "BUDDY");
+
+	int aligned = test_aligned(FIXED_POOL, "FIXED_POOL") + test_aligned(FIRST_FIT, "FIRST_FIT") +
+	              test_aligned(TLSF, "TLSF") + test_aligned(BUDDY, "BUDDY");
+	printf("[T_09] %d out of 4 aligned allocation tests passed!\r\n", aligned);
+	return aligned == 4;
+}
+#endif
+
 /*
  *===========================================================================
  *                             END OF FILE
@@ -47,7 +47,7 @@ void ktask1(void)
 {
     int i = 0;
     int j = 0;
-    long int x = 0;
+    TIMEVAL delay = {0, DELAY_USEC};
 
     while (1) {
         char out_char = 'A' + i % 26;
@@ -57,7 +57,7 @@ void ktask1(void)
 
         SER_PutStr(0,"\n\r");
 
-        for ( x = 0; x < DELAY; x++);
+        k_tsk_suspend(&delay);
 
         if ( (++i) % 6 == 0 ) {
             SER_PutStr(0,"priv_task1 before yielding cpu.\n\r");
@@ -77,7 +77,7 @@ void ktask1(void)
 
 void ktask2(void)
 {
-    long int x = 0;
+    TIMEVAL delay = {0, DELAY_USEC};
     int i = 0;
     int j = 0;
     task_t tid;
@@ -93,7 +93,7 @@ void ktask2(void)
         }
         SER_PutStr(0,"\n\r");
 
-        for ( x = 0; x < DELAY; x++); // some artifical delay
+        k_tsk_suspend(&delay); // some artifical delay
         if ( i%6 == 0 ) {
             SER_PutStr(0,"priv_task2 before yielding CPU.\n\r");
             k_tsk_yield();
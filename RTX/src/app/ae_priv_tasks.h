@@ -37,7 +37,7 @@
  *                             MACROS
  *===========================================================================
  */
-#define DELAY 5000000
+#define DELAY_USEC 100000     // pause between lines, the task sleeps instead of spinning
 
 /*
  *===========================================================================
@@ -832,6 +832,597 @@ void utask2(void) {
 
 #endif
 
+#if TEST == 9
+
+/*
+ * Stack high-water mark of a running task. The kernel has to be built
+ * with MEM_STK_PAINT TRUE, otherwise tsk_get_stack_usage fails and so
+ * does the test. The task writes STK_PROBE bytes of its user stack, the
+ * mark must cover them and stay inside the stack.
+ */
+#define STK_PROBE	0x200
+
+static unsigned int stk_probe(void) {
+	volatile U8 depth[STK_PROBE];
+	unsigned int sum = 0;
+
+	for (int i = 0; i < STK_PROBE; i++) {
+		depth[i] = (U8)i;
+	}
+	for (int i = 0; i < STK_PROBE; i++) {
+		sum += depth[i];
+	}
+	return sum;
+}
+
+/*
+ * A task that allocates from its own arena and exits without freeing.
+ * Its blocks come from the arena, which was counted as used when it was
+ * made, and its exit must hand all of it back in one free.
+ */
+#define ARENA_SIZE	4096
+#define ARENA_BLKS	32
+
+static volatile int arena_result;
+
+void arena_task(void) {
+	RTX_MEM_STATS made, filled;
+	int ok = (mem_arena_create(ARENA_SIZE) == RTX_OK);
+
+	mem_stats(&made);
+	for (int i = 0; i < ARENA_BLKS; i++) {
+		ok = ok && (mem_alloc(24 + 8 * (i % 8)) != NULL);
+	}
+	mem_stats(&filled);
+	arena_result = ok && filled.used == made.used && filled.num_allocs == made.num_allocs + ARENA_BLKS;
+	tsk_exit();
+}
+
+static int test_arena(void) {
+	RTX_MEM_STATS before, after;
+	task_t tid;
+
+	arena_result = 0;
+	mem_stats(&before);
+	// the arena task runs at once and is gone when tsk_create returns
+	if (tsk_create(&tid, &arena_task, HIGH, 0x200) != RTX_OK) {
+		return 0;
+	}
+	mem_stats(&after);
+	printf("[T_09] arena: heap used %u before, %u after the task exits\r\n", before.used, after.used);
+	return arena_result && after.used == before.used;
+}
+
+void utask1(void) {
+	RTX_STK_USAGE usage;
+	int passed = 0;
+
+	printf("[UT1] Info: Entering user task 1!\r\n");
+
+	utid1 = tsk_get_tid();
+	stk_probe();
+	if (tsk_get_stack_usage(utid1, &usage) != RTX_OK) {
+		printf("[T_09] stack usage failed, build the kernel with MEM_STK_PAINT\r\n");
+	} else {
+		printf("[T_09] stack use: kernel %u of %u, user %u of %u bytes\r\n",
+		       usage.k_stack_used, usage.k_stack_size, usage.u_stack_used, usage.u_stack_size);
+		passed = (usage.u_stack_used >= STK_PROBE && usage.u_stack_used <= usage.u_stack_size &&
+		          usage.k_stack_used <= usage.k_stack_size);
+	}
+	passed += test_arena();
+
+	printf("============================================\r\n");
+	printf("=============Final test results=============\r\n");
+	printf("============================================\r\n");
+	printf("[T_09] %d out of 2 tests passed!\r\n", passed);
+	tsk_exit();
+}
+
+#endif
+
+#if TEST == 10
+
+/*
+ * Context switch cost with 2, 16 and 158 ready tasks at one priority.
+ * Every task yields SWITCH_ROUNDS times, so each yield is one switch.
+ * Times are A9 private timer ticks, 1 us after k_rtx_init.
+ */
+#define SWITCH_ROUNDS	1000
+
+void switch_worker(void) {
+	for (int i = 0; i < SWITCH_ROUNDS; i++) {
+		tsk_yield();
+	}
+	tsk_exit();
+}
+
+static void bench_switch(int n) {
+	task_t tid;
+	int created = 1;
+
+	for (int i = 1; i < n; i++) {
+		if (tsk_create(&tid, &switch_worker, MEDIUM, 0x200) != RTX_OK) {
+			break;
+		}
+		created++;
+	}
+
+	unsigned int start = timer_get_current_val(2);
+	for (int i = 0; i < SWITCH_ROUNDS; i++) {
+		tsk_yield();
+	}
+	unsigned int ticks = start - timer_get_current_val(2);	// timer counts down
+
+	// step aside so the workers can finish and hand their TIDs back
+	tsk_set_prio(utid1, LOW);
+	tsk_set_prio(utid1, MEDIUM);
+
+	printf("[T_10] %3d ready tasks: %u us for %d switches, %u ns per switch\r\n",
+	       created, ticks, created * SWITCH_ROUNDS,
+	       (ticks * 1000) / (created * SWITCH_ROUNDS));
+}
+
+void utask1(void) {
+	printf("[UT1] Info: Entering user task 1!\r\n");
+
+	utid1 = tsk_get_tid();
+
+	bench_switch(2);
+	bench_switch(16);
+	bench_switch(158);
+
+	printf("============================================\r\n");
+	printf("[T_10] Context switch benchmark done!\r\n");
+	tsk_exit();
+}
+
+#endif
+
+#if TEST == 11
+
+/*
+ * Two tasks of the same priority that never yield. utask2 only runs if
+ * the tick preempts utask1, and utask1 only spins on if the tick then
+ * preempts utask2 in turn. utask2 gives up after SPIN_LIMIT spins.
+ */
+#define SPIN_LIMIT	100000000
+
+volatile unsigned int spins1 = 0;
+volatile unsigned int spins2 = 0;
+volatile int done = 0;
+
+void utask1(void) {
+	printf("[UT1] Info: Entering user task 1!\r\n");
+
+	utid1 = tsk_get_tid();
+	while (!done) {
+		spins1++;
+	}
+	printf("[T_11] utask1 spun %u times\r\n", spins1);
+	tsk_exit();
+}
+
+void utask2(void) {
+	printf("[UT2] Info: Entering user task 2!\r\n");
+
+	utid2 = tsk_get_tid();
+	unsigned int seen = spins1;
+	while (spins1 == seen && spins2 < SPIN_LIMIT) {
+		spins2++;
+	}
+	int passed = (spins1 != seen);
+	done = 1;
+
+	printf("============================================\r\n");
+	printf("=============Final test results=============\r\n");
+	printf("============================================\r\n");
+	if (!passed) {
+		printf("[T_11] utask1 did not run again within %u spins\r\n", SPIN_LIMIT);
+	}
+	printf("[T_11] %d out of 1 tests passed!\r\n", passed);
+	tsk_exit();
+}
+
+#endif
+
+#if TEST == 12
+
+/*
+ * EDF deadline misses at rising utilization. Four periodic tasks share the
+ * load in equal parts, each job burns its budget in a calibrated loop and
+ * checks its finish time against the end of its period. The first release
+ * is taken as the start of the first job, which is exact to within one
+ * rtx_time_qtm because a new real-time task preempts the creator at once.
+ * Times are A9 private timer ticks, 1 us after k_rtx_init.
+ */
+#define RT_TASKS		4
+#define RT_HORIZON_US	400000
+
+static const unsigned int rt_periods_us[RT_TASKS] = {5000, 10000, 20000, 40000};
+static const unsigned int rt_utils[] = {70, 90, 98, 110};	// percent
+
+static unsigned int loops_per_ms;
+static volatile unsigned int next_period_us;
+static volatile unsigned int next_cost_loops;
+static volatile int rt_done;
+static volatile unsigned int rt_jobs;
+static volatile unsigned int rt_misses;
+static RTX_RT_STATS rt_kstats;		// the kernel's view, summed over the workers
+
+static void burn(unsigned int loops) {
+	for (volatile unsigned int i = 0; i < loops; i++);
+}
+
+void rt_worker(void) {
+	// the creator cannot change these before the first job is done
+	unsigned int period = next_period_us;
+	unsigned int cost = next_cost_loops;
+	unsigned int jobs = RT_HORIZON_US / period;
+	unsigned int t0 = timer_get_current_val(2);
+
+	for (unsigned int k = 1; k <= jobs; k++) {
+		burn(cost);
+		if (t0 - timer_get_current_val(2) > k * period) {	// timer counts down
+			rt_misses++;
+		}
+		rt_jobs++;
+		tsk_done_rt();
+	}
+	RTX_RT_STATS stats;
+	if (tsk_get_rt_stats(tsk_get_tid(), &stats) == RTX_OK) {
+		rt_kstats.jobs += stats.jobs;
+		rt_kstats.misses += stats.misses;
+		if (stats.max_response > rt_kstats.max_response) {
+			rt_kstats.max_response = stats.max_response;
+		}
+		if (stats.max_jitter > rt_kstats.max_jitter) {
+			rt_kstats.max_jitter = stats.max_jitter;
+		}
+	}
+	rt_done++;
+	tsk_exit();
+}
+
+// 1 when every task was admitted and ran all its jobs, and up to U = 90% none
+// missed, above that the kernel overhead and the calibration error can tip it
+static int bench_edf(unsigned int util) {
+	TASK_RT rt;
+	task_t tid;
+	int created = 0;
+	unsigned int expected = 0;
+
+	rt_done = 0;
+	rt_jobs = 0;
+	rt_misses = 0;
+	rt_kstats.jobs = 0;
+	rt_kstats.misses = 0;
+	rt_kstats.max_response = 0;
+	rt_kstats.max_jitter = 0;
+	for (int i = 0; i < RT_TASKS; i++) {
+		rt.p_n.sec = 0;
+		rt.p_n.usec = rt_periods_us[i];
+		rt.task_entry = &rt_worker;
+		rt.u_stack_size = 0x200;
+		rt.rt_mbx_size = 0;
+		next_period_us = rt_periods_us[i];
+		next_cost_loops = loops_per_ms * rt_periods_us[i] / 1000 * util / (100 * RT_TASKS);
+		if (tsk_create_rt(&tid, &rt) != RTX_OK) {
+			printf("[T_12] tsk_create_rt failed at U = %u%%\r\n", util);
+			break;
+		}
+		created++;
+		expected += RT_HORIZON_US / rt_periods_us[i];
+	}
+	// real-time jobs always come first, this only runs while they are idle
+	while (rt_done < created);
+
+	printf("[T_12] U = %3u%%: %u of %u jobs missed their deadline\r\n",
+	       util, rt_misses, rt_jobs);
+	printf("[T_12]           kernel: %u of %u missed, response <= %u us, jitter <= %u us\r\n",
+	       rt_kstats.misses, rt_kstats.jobs, rt_kstats.max_response, rt_kstats.max_jitter);
+	return created == RT_TASKS && rt_kstats.jobs == expected &&
+	       (util > 90 || rt_kstats.misses == 0);
+}
+
+void utask1(void) {
+	printf("[UT1] Info: Entering user task 1!\r\n");
+
+	utid1 = tsk_get_tid();
+
+	unsigned int start = timer_get_current_val(2);
+	burn(100000);
+	loops_per_ms = 100000 * 1000 / (start - timer_get_current_val(2));
+
+	int passed = 0;
+	int total = sizeof(rt_utils) / sizeof(rt_utils[0]);
+	for (int i = 0; i < total; i++) {
+		passed += bench_edf(rt_utils[i]);
+	}
+
+	printf("============================================\r\n");
+	printf("[T_12] %d out of %d tests passed!\r\n", passed, total);
+	tsk_exit();
+}
+
+#endif
+
+#if TEST == 13
+
+/*
+ * RM_PS with a 4 ms of 20 ms polling server. Two periodic tasks at 35% each
+ * must meet every deadline while utask1, a non real-time CPU hog inside the
+ * server, gets no more than the 20% the server allows. Deadlines are checked
+ * as in T_12. Times are A9 private timer ticks, 1 us after k_rtx_init.
+ */
+#define RT_TASKS		2
+#define RT_HORIZON_US	400000
+#define RT_UTIL			35		// percent per task
+
+static const unsigned int rt_periods_us[RT_TASKS] = {5000, 10000};
+
+static unsigned int loops_per_ms;
+static volatile unsigned int next_period_us;
+static volatile int rt_done;
+static volatile unsigned int rt_jobs;
+static volatile unsigned int rt_misses;
+
+static void burn(unsigned int loops) {
+	for (volatile unsigned int i = 0; i < loops; i++);
+}
+
+void rt_worker(void) {
+	// the creator cannot change this before the first job is done
+	unsigned int period = next_period_us;
+	unsigned int cost = loops_per_ms * period / 1000 * RT_UTIL / 100;
+	unsigned int jobs = RT_HORIZON_US / period;
+	unsigned int t0 = timer_get_current_val(2);
+
+	for (unsigned int k = 1; k <= jobs; k++) {
+		burn(cost);
+		if (t0 - timer_get_current_val(2) > k * period) {	// timer counts down
+			rt_misses++;
+		}
+		rt_jobs++;
+		tsk_done_rt();
+	}
+	rt_done++;
+	tsk_exit();
+}
+
+void utask1(void) {
+	TASK_RT rt;
+	task_t tid;
+	int created = 0;
+
+	printf("[UT1] Info: Entering user task 1!\r\n");
+
+	utid1 = tsk_get_tid();
+
+	// short enough to fit in one server budget
+	unsigned int start = timer_get_current_val(2);
+	burn(10000);
+	loops_per_ms = 10000 * 1000 / (start - timer_get_current_val(2));
+
+	for (int i = 0; i < RT_TASKS; i++) {
+		rt.p_n.sec = 0;
+		rt.p_n.usec = rt_periods_us[i];
+		rt.task_entry = &rt_worker;
+		rt.u_stack_size = 0x200;
+		rt.rt_mbx_size = 0;
+		next_period_us = rt_periods_us[i];
+		if (tsk_create_rt(&tid, &rt) != RTX_OK) {
+			printf("[T_13] tsk_create_rt failed\r\n");
+			break;
+		}
+		created++;
+	}
+
+	// hog the CPU and count how much of it the server hands out
+	unsigned int loops = 0;
+	start = timer_get_current_val(2);
+	while (rt_done < created) {
+		burn(100);
+		loops += 100;
+	}
+	unsigned int elapsed_us = start - timer_get_current_val(2);
+
+	printf("[T_13] %u of %u jobs missed their deadline\r\n", rt_misses, rt_jobs);
+	printf("[T_13] utask1 got %u%% of the CPU, the server allows 20%%\r\n",
+	       (loops / loops_per_ms) * 100 / (elapsed_us / 1000));
+	printf("============================================\r\n");
+	printf("[T_13] RM polling server test done!\r\n");
+	tsk_exit();
+}
+
+#endif
+
+#if TEST == 14
+
+/*
+ * RM_NPS admission. The requests below are admitted or refused by
+ * tsk_create_rt_wcet in order, the third one only passes the exact
+ * response-time analysis since the set is over the Liu-Layland bound.
+ * A request without a WCET goes through tsk_create_rt, which charges
+ * RT_WCET_TICKS, one tick of MIN_RTX_QTM, per period.
+ * The admitted tasks then run for RT_HORIZON_US, each job burning 90% of
+ * its declared WCET, and must not miss a deadline.
+ */
+#define RT_HORIZON_US	400000
+
+typedef struct rt_req {
+	unsigned int period_us;
+	unsigned int wcet_us;
+	int admit;
+} rt_req;
+
+static const rt_req reqs[] = {
+	{ 5000, 2000, 1},		// U = 0.40
+	{10000, 4000, 1},		// U = 0.80, under the bound for 2 tasks
+	{20000, 5000, 0},		// U = 1.05
+	{20000, 3000, 1},		// U = 0.95, over the bound, R = 19 ms
+	{40000, 4000, 0},		// U = 1.05
+	{ 7000,  340, 0},		// U = 0.999, but the 20 ms task would end at 20.02 ms
+	{ 1000,    0, 0},		// U = 1.05 with the 100 us charged
+};
+
+static unsigned int loops_per_ms;
+static volatile unsigned int next_period_us;
+static volatile unsigned int next_cost_loops;
+static volatile int rt_done;
+static volatile unsigned int rt_jobs;
+static volatile unsigned int rt_misses;
+
+static void burn(unsigned int loops) {
+	for (volatile unsigned int i = 0; i < loops; i++);
+}
+
+void rt_worker(void) {
+	// the creator cannot change these before the first job is done
+	unsigned int period = next_period_us;
+	unsigned int cost = next_cost_loops;
+	unsigned int jobs = RT_HORIZON_US / period;
+	unsigned int t0 = timer_get_current_val(2);
+
+	for (unsigned int k = 1; k <= jobs; k++) {
+		burn(cost);
+		if (t0 - timer_get_current_val(2) > k * period) {	// timer counts down
+			rt_misses++;
+		}
+		rt_jobs++;
+		tsk_done_rt();
+	}
+	rt_done++;
+	tsk_exit();
+}
+
+void utask1(void) {
+	TASK_RT rt;
+	TIMEVAL c_n;
+	task_t tid;
+	int created = 0;
+	int passed = 0;
+	int total = sizeof(reqs) / sizeof(reqs[0]);
+
+	printf("[UT1] Info: Entering user task 1!\r\n");
+
+	utid1 = tsk_get_tid();
+
+	unsigned int start = timer_get_current_val(2);
+	burn(100000);
+	loops_per_ms = 100000 * 1000 / (start - timer_get_current_val(2));
+
+	for (int i = 0; i < total; i++) {
+		rt.p_n.sec = 0;
+		rt.p_n.usec = reqs[i].period_us;
+		rt.task_entry = &rt_worker;
+		rt.u_stack_size = 0x200;
+		rt.rt_mbx_size = 0;
+		c_n.sec = 0;
+		c_n.usec = reqs[i].wcet_us;
+		next_period_us = reqs[i].period_us;
+		next_cost_loops = loops_per_ms * reqs[i].wcet_us / 1000 * 9 / 10;
+
+		int admitted = (reqs[i].wcet_us == 0) ? (tsk_create_rt(&tid, &rt) == RTX_OK) :
+		               (tsk_create_rt_wcet(&tid, &rt, &c_n) == RTX_OK);
+		if (admitted == reqs[i].admit) {
+			passed++;
+		} else {
+			printf("[T_14] period %u us, wcet %u us: expected %s\r\n", reqs[i].period_us,
+			       reqs[i].wcet_us, reqs[i].admit ? "admit" : "reject");
+		}
+		created += admitted;
+	}
+
+	while (rt_done < created);
+	printf("[T_14] %u of %u jobs missed their deadline\r\n", rt_misses, rt_jobs);
+	passed += (rt_misses == 0);
+
+	printf("============================================\r\n");
+	printf("=============Final test results=============\r\n");
+	printf("============================================\r\n");
+	printf("[T_14] %d out of %d tests passed!\r\n", passed, total + 1);
+	tsk_exit();
+}
+
+#endif
+
+#if TEST == 15
+
+/*
+ * utask1 creates sleepers with staggered sleeps and then sleeps itself.
+ * They must wake in the order of their deadlines, no earlier than asked
+ * and no later than one rtx_time_qtm after. utask2 spins at LOW and counts
+ * how much CPU the sleepers left for it.
+ */
+#define SLEEPERS		5
+#define QTM_US			MIN_RTX_QTM
+
+static const unsigned int sleep_us[SLEEPERS] = {30000, 10000, 50000, 10000, 20000};
+static volatile int next_sleeper;
+static volatile int wake_order[SLEEPERS];
+static volatile int woken;
+static volatile int passed;
+static volatile unsigned int idle_loops;
+
+void sleeper(void) {
+	int me = next_sleeper;
+	TIMEVAL tv = {0, sleep_us[me]};
+
+	unsigned int start = timer_get_current_val(2);
+	tsk_suspend(&tv);
+	unsigned int slept = start - timer_get_current_val(2);	// timer counts down
+
+	wake_order[woken++] = me;
+	if (slept + QTM_US >= sleep_us[me] && slept <= sleep_us[me] + QTM_US) {
+		passed++;
+	} else {
+		printf("[T_15] sleeper %d slept %u us for %u us\r\n", me, slept, sleep_us[me]);
+	}
+	tsk_exit();
+}
+
+void utask1(void) {
+	TIMEVAL tv = {0, 100000};
+	task_t tid;
+
+	printf("[UT1] Info: Entering user task 1!\r\n");
+
+	utid1 = tsk_get_tid();
+	for (int i = 0; i < SLEEPERS; i++) {
+		next_sleeper = i;
+		tsk_create(&tid, &sleeper, HIGH, 0x200);	// runs up to its sleep right away
+	}
+	tsk_suspend(&tv);
+
+	// sleepers of equal length wake in the order they went to sleep
+	int ordered = 1;
+	for (int i = 1; i < woken; i++) {
+		if (sleep_us[wake_order[i]] < sleep_us[wake_order[i - 1]] ||
+		    (sleep_us[wake_order[i]] == sleep_us[wake_order[i - 1]] && wake_order[i] < wake_order[i - 1])) {
+			ordered = 0;
+		}
+	}
+	passed += ordered && (woken == SLEEPERS);
+
+	printf("[T_15] utask2 spun %u loops while everyone slept\r\n", idle_loops);
+	printf("============================================\r\n");
+	printf("=============Final test results=============\r\n");
+	printf("============================================\r\n");
+	printf("[T_15] %d out of %d tests passed!\r\n", passed, SLEEPERS + 1);
+	tsk_exit();
+}
+
+void utask2(void) {
+	printf("[UT2] Info: Entering user task 2!\r\n");
+
+	utid2 = tsk_get_tid();
+	while (1) {
+		idle_loops++;
+	}
+}
+
+#endif
+
 /*
  *===========================================================================
  *                             END OF FILE
@@ -11,6 +11,10 @@ static int messageSize = 0;
 
 static char command_msg[64];
 
+#define SCHED_HIST_CMD  'H'     // built in unless a task registers it
+
+static RTX_SCHED_HIST sched_hist;   // too big for the KCD stack
+
 void init_msg_buffer(){
     messageSize = 0;
     for(int i = 0; i<64; i++){
@@ -40,12 +44,48 @@ void add_command(char command){
     messageSize++;
 }
 
+// one histogram on one line, nothing for an empty one
+static void print_hist_row(int prio, const char *name, U32 *buckets){
+    int last = SCHED_HIST_BUCKETS - 1;
+    while(last >= 0 && buckets[last] == 0){
+        last--;
+    }
+    if(last < 0){
+        return;
+    }
+    printf("\r\n%3d %s", prio, name);
+    for(int i = 0; i <= last; i++){
+        printf(" %u", buckets[i]);
+    }
+}
+
+// %H, the scheduling histograms of every priority level with samples
+static void print_sched_hist(){
+    if(tsk_get_sched_hist(PRIO_NULL, &sched_hist) != RTX_OK){
+        SER_PutStr(1, "\r\nScheduling histograms are off, build with SCHED_HIST\r\n");
+        return;
+    }
+    printf("\r\nprio, then counts of <1 1 2-3 4-7 ... us");
+    for(int prio = 0; prio <= PRIO_NULL; prio++){
+        tsk_get_sched_hist((U8)prio, &sched_hist);
+        print_hist_row(prio, "wake  ", sched_hist.wake_lat);
+        print_hist_row(prio, "switch", sched_hist.switch_cost);
+    }
+    printf("\r\n");
+}
+
 void clear_queue(){
     char identifier = command_msg[1];
     if(!(isalnum((int)identifier)) || messageSize > 64){
         send_invalid_command();
         return;
     }
+    if(identifier == SCHED_HIST_CMD && messageSize == 2 &&
+       (registered_commands[(int)identifier - 32] == 0 || g_tcbs[registered_commands[(int)identifier - 32]].state == DORMANT)){
+        print_sched_hist();
+        init_msg_buffer();
+        return;
+    }
     if(registered_commands[(int)identifier - 32] == 0 || g_tcbs[registered_commands[(int)identifier - 32]].state == DORMANT){
         init_msg_buffer();
         char error_msg[] = "Command cannot be processed";
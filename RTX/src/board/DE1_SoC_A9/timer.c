@@ -125,6 +125,16 @@ unsigned int timer_get_current_val(int n)
 	return 0;
 }
 
+int timer_get_irq(int n)
+{
+	// Return the interrupt status, cleared by timer_clear_irq
+	if(n >= 0 && n <= 1)
+		return TIMERS[n]->timer1intstat & 0x1;
+	else if(n == 2)
+		return ARMTIMER->intstat & 0x1;
+	return 0;
+}
+
 void hps_timer_set_irq_mask(int n, int irq_mask)
 {
 	if(n >= 0 && n <= 1)
@@ -45,6 +45,7 @@
 #define SP0_TIMER_BASE  0xFFC08000
 #define SP1_TIMER_BASE  0xFFC09000
 #define ARM0_TIMER_BASE 0xFFFEC600
+#define HPS_TIMER_MHZ   100     // HPS timers count at 100 MHz
 
 typedef unsigned        char uint8_t;
 typedef unsigned short  int uint16_t;
@@ -72,6 +73,7 @@ void timer_set_mode(int n, int mode);                       // set mode, 1 for u
 void timer_set_count(int n, int count);                     // set load count, only effective in user-defined count mode for n = 0-1
 void timer_clear_irq(int n);                                // clear timer's interrupt request
 unsigned int timer_get_current_val(int n);                  // get the current value of the timer's counter
+int timer_get_irq(int n);                                   // non-zero while the timer's interrupt request is pending
 
 void hps_timer_set_irq_mask(int n, int irq_mask);           // set irq mask, 1 for no interrupts and 0 for interrupts
 void a9_timer_set_irq_bit(int n, int irq_bit);              // set irq bit, 0 for no interrupts and 1 for interrupts
@@ -0,0 +1,12 @@
+/**************************************************************************//**
+ * @file     Serial.h
+ * @brief    Host stand-in for the polled UART driver, the host has no UART
+ ******************************************************************************/
+
+#ifndef SERIAL_H_
+#define SERIAL_H_
+
+#define UART0_Init()
+#define UART1_Init()
+
+#endif /* SERIAL_H_ */
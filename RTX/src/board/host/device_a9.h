@@ -0,0 +1,50 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *              Copyright 2020-2021 Yiqing Huang and Zehan Gao
+ *
+ *          This software is subject to an open source license and
+ *          may be freely redistributed under the terms of MIT License.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        device_a9.h
+ * @brief       Host stand-in for the Cortex-A9 device header file
+ *
+ * @note        The host build runs the kernel memory manager as a Linux
+ *              process. RAM is a block the host program allocates, and the
+ *              heap starts at its first word, where the linker would have
+ *              ended the image on the board.
+ *
+ *****************************************************************************/
+
+#ifndef DEVICE_A9_H_
+#define DEVICE_A9_H_
+
+/*
+ *===========================================================================
+ *                             MACROS
+ *===========================================================================
+ */
+extern unsigned int  g_host_ram_start;      // simulated RAM, set before k_mem_init
+extern unsigned int  g_host_ram_end;
+extern unsigned int *g_host_image_end;      // same address as g_host_ram_start
+
+#define RAM_START       g_host_ram_start
+#define RAM_END         g_host_ram_end
+
+// k_inc.h declares the linker symbol, this turns it into a pointer declaration
+#define Image$$ZI_DATA$$ZI$$Limit   (*g_host_image_end)
+
+// armcc intrinsics used by the kernel
+#define __clz(x)        __builtin_clz(x)
+
+#endif
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
@@ -0,0 +1,11 @@
+/**************************************************************************//**
+ * @file     printf.h
+ * @brief    Host stand-in for the tiny printf, the C library provides printf
+ ******************************************************************************/
+
+#ifndef __TFP_PRINTF__
+#define __TFP_PRINTF__
+
+#include <stdio.h>
+
+#endif
@@ -230,9 +230,6 @@ EXIT_IRQ
 
 void c_IRQ_Handler(void)
 {
-	static unsigned int a9_timer_last = 0xFFFFFFFF; // the initial value of free-running timer
-	unsigned int a9_timer_curr;
-
 	char switch_flag = 0;
 	// Read the ICCIAR from the CPU Interface in the GIC
 	U32 interrupt_ID = GIC_AckPending();
@@ -266,11 +263,10 @@ void c_IRQ_Handler(void)
 	else if(interrupt_ID == HPS_TIMER0_IRQ_ID)
 	{
 		timer_clear_irq(0);
-		a9_timer_curr = timer_get_current_val(2);	//get the current value of the free running timer
-		if ((a9_timer_last - a9_timer_curr) > 500000U)
+		// round-robin within a priority, the slice owner goes to the back
+		if (k_tsk_tick())
 		{
-			printf("%d ms passed!\r\n", ((a9_timer_last - a9_timer_curr)/1000U));
-			a9_timer_last = a9_timer_curr;
+			switch_flag = 1;
 		}
 	}
 	else if(interrupt_ID == HPS_TIMER1_IRQ_ID)
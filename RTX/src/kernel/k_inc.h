@@ -43,6 +43,7 @@
 
 #include "device_a9.h"
 #include "common.h"
+#include "common_ext.h"
 
 /*
  *===========================================================================
@@ -72,9 +73,23 @@ typedef struct __mailbox_queue{
     size_t max_size;
 } mailbox_queue;
 
+/**
+ * @brief kernel timeout, see k_timer.h
+ */
+typedef struct ktimer_link {
+    struct ktimer_link *next;       /**> NULL when the timer is not pending  */
+    struct ktimer_link *prev;
+} ktimer_link;
+
+typedef struct ktimer {
+    ktimer_link     link;           /**> slot list of the timing wheel, first */
+    U32             expires;        /**> tick the timer fires at             */
+    void            (*fn)(struct ktimer *);  /**> called from the timer IRQ  */
+    void            *arg;           /**> for fn                              */
+} KTIMER;
 
 typedef struct tcb {
-    struct tcb* 	next;   /**> next tcb, not used in this example         */
+    struct tcb* 	next;   /**> next tcb in the ready queue of its priority */
     U32*        	ksp;    /**> ksp of the task, TCB_KSP_OFFSET = 4        */
     U32          	tid;    /**> task id                                    */
     U8          	prio;   /**> Execution priority                         */
@@ -83,6 +98,18 @@ typedef struct tcb {
     void        (*ptask)();         /**> task entry address                 */
     U16         u_stack_size;       /**> user stack size in bytes           */
     U32         user_stack_ptr; //user stack pointer
+    U16         k_stack_size;       /**> kernel stack size in bytes         */
+    U32         k_stack_hi;         /**> kernel stack base (high addr.)     */
+    struct tcb* prev;               /**> prev tcb in the ready queue of its priority */
+    U32         rt_period;          /**> period in ticks, 0 for non real-time tasks */
+    U32         rt_deadline;        /**> absolute deadline in ticks, next release while suspended */
+    U32         heap_idx;           /**> slot in the EDF ready heap, 0 if not in it */
+    U32         rt_wcet;            /**> worst-case job time in us, RT_WCET_TICKS if undeclared */
+    KTIMER      timer;              /**> wakes the task from a sleep or for its next period */
+    RTX_RT_STATS rt_stats;          /**> job timing of a real-time task */
+    U8          rt_started;         /**> the current job has been dispatched */
+    U8          hist_woken;         /**> hist_wake holds a wake-up not yet dispatched */
+    U32         hist_wake;          /**> A9 timer count of the wake-up, see SCHED_HIST */
     mailbox_queue  mailbox;  //mailbox struct
 } TCB;
 
@@ -96,11 +123,8 @@ typedef struct tcb {
 extern const U32 g_k_stack_size;    // kernel stack size
 extern const U32 g_p_stack_size;    // process stack size for sys mode tasks
 
-// task kernel stacks are statically allocated inside the OS image
-extern U32 g_k_stacks[MAX_TASKS][K_STACK_SIZE >> 2] __attribute__((aligned(8)));
-
-// process stack for tasks in SYS mode, statically allocated inside the OS image  */
-extern U32 g_p_stacks[MAX_TASKS][U_STACK_SIZE >> 2] __attribute__((aligned(8)));
+// boot SVC stack inside the OS image, the null task keeps running on it
+extern U32 g_k_stacks[1][K_STACK_SIZE >> 2] __attribute__((aligned(8)));
 
 extern unsigned int Image$$ZI_DATA$$ZI$$Limit; 	// Linker defined symbol
                                                 // See ARM Compiler User Guide 5.x
@@ -112,6 +136,10 @@ extern TCB *gp_current_task;    // always point to the current RUNNING task
 extern TCB g_tcbs[MAX_TASKS];
 extern RTX_TASK_INFO g_null_task_info;
 extern U32 g_num_active_tasks;	// number of non-dormant tasks */
+extern U32 g_rtx_ticks;         // rtx_time_qtm ticks since k_rtx_init
+
+// system configuration is defined in k_rtx_init.c
+extern RTX_SYS_INFO g_sys_info;
 //extern TCB* head_task;
 //extern static TCB* head_task;
 
@@ -73,11 +73,8 @@ const U32 g_p_stack_size = U_STACK_SIZE;
 
 int heap_size;
 
-// task kernel stacks
-U32 g_k_stacks[MAX_TASKS][K_STACK_SIZE >> 2] __attribute__((aligned(8)));
-
-// process stack for tasks in SYS mode
-U32 g_p_stacks[MAX_TASKS][U_STACK_SIZE >> 2] __attribute__((aligned(8)));
+// boot SVC stack, kept by the null task; created tasks get theirs from the stack region
+U32 g_k_stacks[1][K_STACK_SIZE >> 2] __attribute__((aligned(8)));
 
 /*
  *===========================================================================
@@ -85,75 +82,1449 @@ U32 g_p_stacks[MAX_TASKS][U_STACK_SIZE >> 2] __attribute__((aligned(8)));
  *===========================================================================
  */
 
-typedef struct
+typedef struct
+{
+    int size;
+    unsigned int task_id;
+} header_T;
+
+typedef struct __node_t
+{
+    int size;
+    struct __node_t *next;
+    struct __node_t *prev;
+} node_t;
+
+node_t *head;
+node_t* tail;
+unsigned int end_addr;
+int mem_algo = MEM_ALGO;
+
+/*
+ *---------------------------------------------------------------------------
+ * Heap blocks carry boundary tags so that neighbours are found in O(1):
+ *   used block: [ size|flags | task_id | payload ...              ]
+ *   free block: [ size|flags | next    | prev    | ... | size      ]
+ * The low bits of the size word are flags, sizes are multiples of 8.
+ * head and tail are used blocks fencing the heap, they also anchor the
+ * first-fit free list which is kept in address order.
+ * An aligned payload that does not start its block is preceded by a tag:
+ *   aligned tag: [ offset|MEM_BLK_ALIGNED | task_id ]
+ * where offset leads back to the payload the block was allocated with.
+ * The task_id word of a used block holds the owner in its low byte and,
+ * for a block from k_mem_alloc_aligned, log2 of the alignment above it.
+ *---------------------------------------------------------------------------
+ */
+#define MEM_BLK_USED        0x1     /* this block is allocated              */
+#define MEM_BLK_PREV_FREE   0x2     /* the block physically before is free  */
+#define MEM_BLK_POOL        0x4     /* fixed size block owned by a pool     */
+#define MEM_BLK_FLAGS       0x7
+#define MEM_BLK_ALIGNED     0x7     /* tag in front of an aligned payload, pool blocks are never PREV_FREE */
+#define MEM_BLK_MIN         16      /* header, two links and a footer       */
+#define MEM_OWNER_MASK      0xFF    /* owner TID in the task_id word        */
+#define MEM_ALIGN_SHIFT     8       /* log2 of the alignment above the owner */
+
+#define TLSF_SL_LOG2        4                           /* 16 second level lists */
+#define TLSF_SL_COUNT       (1 << TLSF_SL_LOG2)
+#define TLSF_FL_SHIFT       (TLSF_SL_LOG2 + 3)          /* 3 = log2(8B alignment) */
+#define TLSF_FL_MAX         30                          /* blocks are below 1 GB  */
+#define TLSF_FL_COUNT       (TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+#define TLSF_SMALL_BLK      (1 << TLSF_FL_SHIFT)        /* linear classes below   */
+
+U32 tlsf_fl_bitmap;
+U32 tlsf_sl_bitmap[TLSF_FL_COUNT];
+node_t *tlsf_lists[TLSF_FL_COUNT][TLSF_SL_COUNT];
+
+typedef struct __mem_pool_t
+{
+    U32 start;          // header of the first block
+    U32 end;            // one past the last block
+    U32 stride;         // header plus payload rounded up to 8 bytes
+    U32 blk_size;       // largest request served by this pool
+    U32 num_free;
+    node_t *free;       // stack of free blocks, linked through the header
+} mem_pool_t;
+
+#define BUDDY_ORDERS        26      /* blocks of MEM_BLK_MIN << 0..25, up to 512 MB */
+
+node_t *buddy_lists[BUDDY_ORDERS];
+U32 buddy_bitmap;
+U32 buddy_waste;                    // bytes allocated beyond the rounded requests
+
+U32 mem_free_hist[MEM_HIST_BUCKETS];    // free heap blocks per power of two of size
+U32 mem_hist_bitmap;                    // buckets holding at least one block
+
+/*
+ * Free block sizes in more detail than the histogram, so that mem_stats
+ * and extfrag never walk the heap. Sizes below MEM_EXACT_MAX are counted
+ * one by one, they are multiples of 8, with a Fenwick tree over size / 8
+ * for the number below a size and a bitmap for the largest. Free blocks
+ * from MEM_EXACT_MAX up are listed by size class, 16 classes per power of
+ * two, through two links behind their node. Each class list is sorted by
+ * size, smallest first, so a free walks its class to find its place and
+ * the largest block ends the list. A class holds blocks within 1/16 of
+ * each other in size.
+ * BUDDY sizes are powers of two, the histogram alone is exact for them.
+ */
+#define MEM_EXACT_LOG2      12
+#define MEM_EXACT_MAX       (1U << MEM_EXACT_LOG2)
+#define MEM_EXACT_SLOTS     (MEM_EXACT_MAX >> 3)
+#define MEM_BIG_SL_LOG2     4
+#define MEM_BIG_SL_COUNT    (1 << MEM_BIG_SL_LOG2)
+#define MEM_BIG_FL_COUNT    (32 - MEM_EXACT_LOG2)
+
+typedef struct __mem_big_t
+{
+    struct __mem_big_t *next;
+    struct __mem_big_t *prev;
+} mem_big_t;                            // sits right behind the node_t of a free block
+
+U32 mem_exact_cnt[MEM_EXACT_SLOTS];     // free blocks of size slot * 8
+U32 mem_exact_tree[MEM_EXACT_SLOTS + 1];// 1-based Fenwick tree over mem_exact_cnt
+U32 mem_exact_map[MEM_EXACT_SLOTS >> 5];// slots holding at least one block
+U32 mem_exact_group;                    // words of mem_exact_map with a bit set
+mem_big_t *mem_big_lists[MEM_BIG_FL_COUNT][MEM_BIG_SL_COUNT];
+mem_big_t *mem_big_last[MEM_BIG_FL_COUNT][MEM_BIG_SL_COUNT];    // largest block of the class
+U32 mem_big_cnt[MEM_BIG_FL_COUNT][MEM_BIG_SL_COUNT];
+U32 mem_big_fl_map;
+U32 mem_big_sl_map[MEM_BIG_FL_COUNT];
+RTX_MEM_STATS g_mem_stats;              // counters kept up to date by every call
+
+#define ARENA_CLASSES       5       /* blocks of MEM_BLK_MIN << 0..4, header included */
+#define ARENA_MAX_BLK       (MEM_BLK_MIN << (ARENA_CLASSES - 1))
+
+typedef struct __mem_arena_t
+{
+    U32 start;          // zero when the task has no arena
+    U32 end;
+    U32 top;            // blocks below top have been handed out at least once
+    node_t *free[ARENA_CLASSES];
+} mem_arena_t;
+
+mem_arena_t mem_arenas[MAX_TASKS];
+
+#define SLAB_PAGE_SIZE      4096
+#define SLAB_PAGES          64      /* 256 KB shared by all slab classes   */
+#define SLAB_FREE           0xFE    /* owner of an object nobody holds      */
+#define SLAB_NONE           0xFD    /* no object starts in this granule     */
+#define SLAB_GRANULES       (SLAB_PAGE_SIZE >> 3)
+
+typedef struct __slab_t
+{
+    struct __slab_t *next;  // pages of the class that still have free objects
+    struct __slab_t *prev;
+    void *free;             // free objects, linked through their first word
+    U16 class;
+    U16 in_use;
+} slab_t;                   // followed by one owner byte per 8 byte granule, then the objects
+
+const U8 slab_obj_size[SLAB_CLASSES] = { 8, 16, 24, 32, 48, 64 };
+const U8 slab_class_of[(SLAB_MAX_OBJ >> 3) + 1] = { 0, 0, 1, 2, 3, 4, 4, 5, 5 };
+U16 slab_capacity[SLAB_CLASSES];    // objects per page
+U32 slab_start;                     // zero when the slab layer is off
+U32 slab_end;
+slab_t *slab_free_pages;
+slab_t *slab_partial[SLAB_CLASSES];
+RTX_SLAB_STATS slab_stats;
+
+#define STK_MIN_SIZE        0x200   /* smallest stack class, K_STACK_SIZE and U_STACK_SIZE */
+#define STK_CLASSES         5       /* stacks of STK_MIN_SIZE << 0..4 bytes */
+#define STK_MAX_SIZE        (STK_MIN_SIZE << (STK_CLASSES - 1))
+#define STK_PAINT_WORD      0xDEADBEEF  /* fill of stack words never written */
+
+U32 stk_start;                      // zero when there is no stack region
+U32 stk_end;
+U32 stk_top;                        // stacks below top have been handed out at least once
+U32 *stk_free[STK_CLASSES];         // free stacks, linked through their lowest word
+U32 stk_used;
+U32 stk_peak_used;
+U32 stk_spills;
+
+mem_pool_t mem_pools[MEM_MAX_POOLS];
+int mem_num_pools;
+
+// FIXED_POOL pools built by k_mem_init, smallest block size first
+MEM_POOL_INFO g_mem_pool_info[] = {
+    { 8,            MAX_TASKS },    // free TID nodes from insert_node
+    { 16,           64 },           // KEY_IN and KCD_REG messages
+    { 72,           32 },           // KCD_CMD messages, header plus a 64 char command
+    { KCD_MBX_SIZE + CACHE_LINE_SIZE, 8 },  // mailbox buffers, room to align them to a cache line
+};
+
+/*
+ *---------------------------------------------------------------------------
+ * boundary tag helpers
+ *---------------------------------------------------------------------------
+ */
+
+static __inline U32 mem_owner(void)
+{
+    return (gp_current_task == NULL) ? TID_NULL : gp_current_task->tid;
+}
+
+static __inline U32 blk_owner(header_T *blk)
+{
+    return blk->task_id & MEM_OWNER_MASK;
+}
+
+static __inline U32 mem_fls(U32 word)
+{
+    return 31 - __clz(word);            // index of the highest set bit, word != 0
+}
+
+static __inline U32 mem_ffs(U32 word)
+{
+    return mem_fls(word & (~word + 1)); // index of the lowest set bit, word != 0
+}
+
+static __inline U32 blk_size(header_T *blk)
+{
+    return (U32)blk->size & ~MEM_BLK_FLAGS;
+}
+
+static __inline header_T *blk_next_phys(header_T *blk)
+{
+    return (header_T *)((U32)blk + blk_size(blk));
+}
+
+static __inline header_T *blk_prev_phys(header_T *blk)
+{
+    // only valid when blk has MEM_BLK_PREV_FREE set, the footer is the word below blk
+    return (header_T *)((U32)blk - *((U32 *)blk - 1));
+}
+
+static __inline mem_big_t *big_link(void *blk)
+{
+    return (mem_big_t *)((U32)blk + sizeof(node_t));
+}
+
+static __inline U32 big_size(mem_big_t *link)
+{
+    return blk_size((header_T *)((U32)link - sizeof(node_t)));
+}
+
+static __inline void big_class(U32 size, U32 *fl, U32 *sl)
+{
+    U32 f = mem_fls(size);
+
+    *fl = f - MEM_EXACT_LOG2;
+    *sl = (size >> (f - MEM_BIG_SL_LOG2)) & (MEM_BIG_SL_COUNT - 1);
+}
+
+static void exact_update(U32 slot, U32 delta)
+{
+    for (U32 i = slot + 1; i <= MEM_EXACT_SLOTS; i += i & (~i + 1)) {
+        mem_exact_tree[i] += delta;
+    }
+}
+
+// free blocks in the slots below slots
+static U32 exact_below(U32 slots)
+{
+    U32 sum = 0;
+
+    for (U32 i = slots; i > 0; i &= i - 1) {
+        sum += mem_exact_tree[i];
+    }
+    return sum;
+}
+
+// every free heap block is counted in the histogram bucket of its size,
+// blk is NULL for BUDDY blocks, which are left out of the detail
+static void hist_add(void *blk, U32 size)
+{
+    U32 bucket = mem_fls(size);
+
+    mem_free_hist[bucket]++;
+    mem_hist_bitmap |= (1U << bucket);
+    g_mem_stats.free_blks++;
+    if (blk == NULL) {
+        return;
+    }
+
+    if (size < MEM_EXACT_MAX) {
+        U32 slot = size >> 3;
+        if (mem_exact_cnt[slot]++ == 0) {
+            mem_exact_map[slot >> 5] |= (1U << (slot & 31));
+            mem_exact_group |= (1U << (slot >> 5));
+        }
+        exact_update(slot, 1);
+        return;
+    }
+
+    U32 fl, sl;
+    mem_big_t *link = big_link(blk);
+    mem_big_t *before = NULL;
+    mem_big_t *after;
+    big_class(size, &fl, &sl);
+    for (after = mem_big_lists[fl][sl]; after != NULL && big_size(after) < size; after = after->next) {
+        before = after;
+    }
+    link->prev = before;
+    link->next = after;
+    if (after != NULL) {
+        after->prev = link;
+    } else {
+        mem_big_last[fl][sl] = link;
+    }
+    if (before != NULL) {
+        before->next = link;
+    } else {
+        mem_big_lists[fl][sl] = link;
+    }
+    mem_big_cnt[fl][sl]++;
+    mem_big_fl_map |= (1U << fl);
+    mem_big_sl_map[fl] |= (1U << sl);
+}
+
+static void hist_sub(void *blk, U32 size)
+{
+    U32 bucket = mem_fls(size);
+
+    if (--mem_free_hist[bucket] == 0) {
+        mem_hist_bitmap &= ~(1U << bucket);
+    }
+    g_mem_stats.free_blks--;
+    if (blk == NULL) {
+        return;
+    }
+
+    if (size < MEM_EXACT_MAX) {
+        U32 slot = size >> 3;
+        if (--mem_exact_cnt[slot] == 0) {
+            mem_exact_map[slot >> 5] &= ~(1U << (slot & 31));
+            if (mem_exact_map[slot >> 5] == 0) {
+                mem_exact_group &= ~(1U << (slot >> 5));
+            }
+        }
+        exact_update(slot, (U32)-1);
+        return;
+    }
+
+    U32 fl, sl;
+    mem_big_t *link = big_link(blk);
+    big_class(size, &fl, &sl);
+    if (link->next != NULL) {
+        link->next->prev = link->prev;
+    } else {
+        mem_big_last[fl][sl] = link->prev;
+    }
+    if (link->prev != NULL) {
+        link->prev->next = link->next;
+    } else {
+        mem_big_lists[fl][sl] = link->next;
+    }
+    if (--mem_big_cnt[fl][sl] == 0) {
+        mem_big_sl_map[fl] &= ~(1U << sl);
+        if (mem_big_sl_map[fl] == 0) {
+            mem_big_fl_map &= ~(1U << fl);
+        }
+    }
+}
+
+static void blk_set_free(header_T *blk, U32 size)
+{
+    hist_add(blk, size);
+    blk->size = size | ((U32)blk->size & MEM_BLK_PREV_FREE);
+    *((U32 *)((U32)blk + size) - 1) = size;
+    blk_next_phys(blk)->size |= MEM_BLK_PREV_FREE;
+}
+
+static void blk_set_used(header_T *blk, U32 size)
+{
+    blk->size = size | MEM_BLK_USED | ((U32)blk->size & MEM_BLK_PREV_FREE);
+    blk->task_id = mem_owner();
+    blk_next_phys(blk)->size &= ~MEM_BLK_PREV_FREE;
+}
+
+static int blk_check(header_T *blk)
+{
+    U32 size = blk_size(blk);
+
+    // a live block is marked used, lies inside the heap and its successor agrees
+    return (blk->size & MEM_BLK_USED) && size >= MEM_BLK_MIN &&
+           size <= (U32)tail - (U32)blk && !(blk_next_phys(blk)->size & MEM_BLK_PREV_FREE);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * FIRST_FIT: one free list in address order, a block is split on alloc and
+ * merged with its free neighbours on dealloc. Only a free block without free
+ * neighbours has to look for its place in the list. Used blocks carry no
+ * footer to lead back to the free block before them, so that search stays
+ * a walk of the list, O(n) in the free blocks. It starts from the end of
+ * the heap blk is nearer to.
+ *---------------------------------------------------------------------------
+ */
+
+static __inline void ff_link(node_t *blk, node_t *prev, node_t *next)
+{
+    blk->prev = prev;
+    blk->next = next;
+    prev->next = blk;
+    next->prev = blk;
+}
+
+static __inline void ff_unlink(node_t *blk)
+{
+    blk->prev->next = blk->next;
+    blk->next->prev = blk->prev;
+}
+
+static void *ff_alloc(U32 size)
+{
+    node_t *node = head->next;
+
+    while (node != tail && blk_size((header_T *)node) < size) {
+        node = node->next;
+    }
+    if (node == tail) {
+        return NULL;
+    }
+
+    header_T *blk = (header_T *)node;
+    U32 old_size = blk_size(blk);
+    hist_sub(blk, old_size);
+    if (old_size - size >= MEM_BLK_MIN) {
+        // the rest of the block stays free and keeps its place in the list
+        header_T *rest = (header_T *)((U32)blk + size);
+        blk->size = size;
+        rest->size = 0;
+        blk_set_free(rest, old_size - size);
+        ff_link((node_t *)rest, node->prev, node->next);
+    } else {
+        ff_unlink(node);
+        size = old_size;
+    }
+    blk_set_used(blk, size);
+    return (void *)((U32)blk + sizeof(header_T));
+}
+
+static int ff_dealloc(header_T *blk)
+{
+    U32 size = blk_size(blk);
+    header_T *next = blk_next_phys(blk);
+
+    if (blk->size & MEM_BLK_PREV_FREE) {
+        // grow the free block in front, it is already in the list
+        header_T *prev = blk_prev_phys(blk);
+        hist_sub(prev, blk_size(prev));
+        size += blk_size(prev);
+        blk->size = 0;      // the stale header must not pass for a used block again
+        blk = prev;
+        if (!(next->size & MEM_BLK_USED)) {
+            ff_unlink((node_t *)next);
+            hist_sub(next, blk_size(next));
+            size += blk_size(next);
+        }
+    } else if (!(next->size & MEM_BLK_USED)) {
+        // absorb the free block behind and take over its place in the list
+        hist_sub(next, blk_size(next));
+        ff_link((node_t *)blk, ((node_t *)next)->prev, ((node_t *)next)->next);
+        size += blk_size(next);
+    } else if ((U32)blk - (U32)head < (U32)tail - (U32)blk) {
+        // isolated, see above, the only case that walks the list
+        node_t *after = head->next;
+        while (after != tail && (U32)after < (U32)blk) {
+            after = after->next;
+        }
+        ff_link((node_t *)blk, after->prev, after);
+    } else {
+        node_t *before = tail->prev;
+        while (before != head && (U32)before > (U32)blk) {
+            before = before->prev;
+        }
+        ff_link((node_t *)blk, before, before->next);
+    }
+    blk_set_free(blk, size);
+    return RTX_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * FIXED_POOL: pools of equal sized blocks carved from the heap at init time.
+ * Free blocks form a stack, so alloc and free are a push or a pop. Requests
+ * larger than every pool, or hitting an exhausted pool, go to first-fit.
+ *---------------------------------------------------------------------------
+ */
+
+static mem_pool_t *pool_of(header_T *blk)
+{
+    for (int i = 0; i < mem_num_pools; i++) {
+        mem_pool_t *pool = &mem_pools[i];
+        if ((U32)blk >= pool->start && (U32)blk < pool->end) {
+            return (((U32)blk - pool->start) % pool->stride == 0) ? pool : NULL;
+        }
+    }
+    return NULL;
+}
+
+static void *pool_alloc(U32 size)
+{
+    for (int i = 0; i < mem_num_pools; i++) {
+        mem_pool_t *pool = &mem_pools[i];
+        if (pool->blk_size >= size && pool->free != NULL) {
+            header_T *blk = (header_T *)pool->free;
+            pool->free = pool->free->next;
+            pool->num_free--;
+            blk->size = pool->stride | MEM_BLK_POOL | MEM_BLK_USED;
+            blk->task_id = mem_owner();
+            return (void *)((U32)blk + sizeof(header_T));
+        }
+    }
+    return NULL;
+}
+
+static void pool_free(mem_pool_t *pool, header_T *blk)
+{
+    node_t *node = (node_t *)blk;
+
+    node->size = pool->stride | MEM_BLK_POOL;
+    node->next = pool->free;
+    pool->free = node;
+    pool->num_free++;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * TLSF: free blocks are kept in segregated lists indexed by a first level
+ * (power of two) and a second level (16 linear steps within it). Two bitmap
+ * lookups find a suitable list, so alloc and free never walk the heap.
+ * BEST_FIT and WORST_FIT share these size classes but keep every list in
+ * address order, so a search only walks the one class holding the answer.
+ *---------------------------------------------------------------------------
+ */
+
+static __inline int mem_segregated(void)
+{
+    return mem_algo == BEST_FIT || mem_algo == WORST_FIT || mem_algo == TLSF;
+}
+
+static void tlsf_mapping(U32 size, int *fl, int *sl)
+{
+    if (size < TLSF_SMALL_BLK) {
+        *fl = 0;
+        *sl = size / (TLSF_SMALL_BLK / TLSF_SL_COUNT);
+    } else {
+        int f = mem_fls(size);
+        *sl = (size >> (f - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+        *fl = f - TLSF_FL_SHIFT + 1;
+    }
+}
+
+static void tlsf_insert(node_t *blk)
+{
+    int fl, sl;
+    node_t *prev = NULL;
+    node_t *next;
+
+    tlsf_mapping(blk->size & ~MEM_BLK_FLAGS, &fl, &sl);
+    next = tlsf_lists[fl][sl];
+    if (mem_algo != TLSF) {
+        while (next != NULL && (U32)next < (U32)blk) {
+            prev = next;
+            next = next->next;
+        }
+    }
+    blk->prev = prev;
+    blk->next = next;
+    if (next != NULL) {
+        next->prev = blk;
+    }
+    if (prev != NULL) {
+        prev->next = blk;
+    } else {
+        tlsf_lists[fl][sl] = blk;
+    }
+    tlsf_fl_bitmap |= (1U << fl);
+    tlsf_sl_bitmap[fl] |= (1U << sl);
+}
+
+static void tlsf_remove(node_t *blk)
+{
+    int fl, sl;
+
+    hist_sub(blk, blk->size & ~MEM_BLK_FLAGS);
+    tlsf_mapping(blk->size & ~MEM_BLK_FLAGS, &fl, &sl);
+    if (blk->next != NULL) {
+        blk->next->prev = blk->prev;
+    }
+    if (blk->prev != NULL) {
+        blk->prev->next = blk->next;
+    } else {
+        tlsf_lists[fl][sl] = blk->next;
+        if (blk->next == NULL) {
+            tlsf_sl_bitmap[fl] &= ~(1U << sl);
+            if (tlsf_sl_bitmap[fl] == 0) {
+                tlsf_fl_bitmap &= ~(1U << fl);
+            }
+        }
+    }
+}
+
+static node_t *tlsf_find(U32 size)
+{
+    int fl, sl;
+    U32 map;
+
+    // round up to the next list so that any block found there is big enough
+    if (size >= TLSF_SMALL_BLK) {
+        size += (1U << (mem_fls(size) - TLSF_SL_LOG2)) - 1;
+    }
+    tlsf_mapping(size, &fl, &sl);
+    if (fl >= TLSF_FL_COUNT) {
+        return NULL;
+    }
+
+    map = tlsf_sl_bitmap[fl] & (~0U << sl);
+    if (map == 0) {
+        map = (fl + 1 < TLSF_FL_COUNT) ? tlsf_fl_bitmap & (~0U << (fl + 1)) : 0;
+        if (map == 0) {
+            return NULL;
+        }
+        fl = mem_ffs(map);
+        map = tlsf_sl_bitmap[fl];
+    }
+    sl = mem_ffs(map);
+    return tlsf_lists[fl][sl];
+}
+
+// smallest block of at least size, the lowest address wins a tie
+static node_t *best_find(U32 size)
+{
+    int fl, sl;
+    U32 map;
+    node_t *best = NULL;
+
+    tlsf_mapping(size, &fl, &sl);
+    if (fl >= TLSF_FL_COUNT) {
+        return NULL;
+    }
+    for (node_t *node = tlsf_lists[fl][sl]; node != NULL; node = node->next) {
+        U32 node_size = node->size & ~MEM_BLK_FLAGS;
+        if (node_size >= size && (best == NULL || node_size < (best->size & ~MEM_BLK_FLAGS))) {
+            best = node;
+        }
+    }
+    if (best != NULL) {
+        return best;
+    }
+
+    // every block in a higher class fits, the answer is the first class up
+    map = (sl + 1 < TLSF_SL_COUNT) ? tlsf_sl_bitmap[fl] & (~0U << (sl + 1)) : 0;
+    if (map == 0) {
+        map = (fl + 1 < TLSF_FL_COUNT) ? tlsf_fl_bitmap & (~0U << (fl + 1)) : 0;
+        if (map == 0) {
+            return NULL;
+        }
+        fl = mem_ffs(map);
+        map = tlsf_sl_bitmap[fl];
+    }
+    sl = mem_ffs(map);
+    best = tlsf_lists[fl][sl];
+    for (node_t *node = best->next; node != NULL; node = node->next) {
+        if ((node->size & ~MEM_BLK_FLAGS) < (best->size & ~MEM_BLK_FLAGS)) {
+            best = node;
+        }
+    }
+    return best;
+}
+
+// largest block, the lowest address wins a tie
+static node_t *worst_find(U32 size)
+{
+    if (tlsf_fl_bitmap == 0) {
+        return NULL;
+    }
+    int fl = mem_fls(tlsf_fl_bitmap);
+    int sl = mem_fls(tlsf_sl_bitmap[fl]);
+    node_t *worst = tlsf_lists[fl][sl];
+
+    for (node_t *node = worst->next; node != NULL; node = node->next) {
+        if ((node->size & ~MEM_BLK_FLAGS) > (worst->size & ~MEM_BLK_FLAGS)) {
+            worst = node;
+        }
+    }
+    return ((worst->size & ~MEM_BLK_FLAGS) >= size) ? worst : NULL;
+}
+
+static void tlsf_init(void)
+{
+    for (int fl = 0; fl < TLSF_FL_COUNT; fl++) {
+        tlsf_sl_bitmap[fl] = 0;
+        for (int sl = 0; sl < TLSF_SL_COUNT; sl++) {
+            tlsf_lists[fl][sl] = NULL;
+        }
+    }
+    tlsf_fl_bitmap = 0;
+}
+
+static void *tlsf_alloc(U32 size)
+{
+    node_t *node;
+
+    if (mem_algo == BEST_FIT) {
+        node = best_find(size);
+    } else if (mem_algo == WORST_FIT) {
+        node = worst_find(size);
+    } else {
+        node = tlsf_find(size);
+    }
+    if (node == NULL) {
+        return NULL;
+    }
+    tlsf_remove(node);
+
+    header_T *blk = (header_T *)node;
+    U32 old_size = blk_size(blk);
+    if (old_size - size >= MEM_BLK_MIN) {
+        header_T *rest = (header_T *)((U32)blk + size);
+        blk->size = size;
+        rest->size = 0;
+        blk_set_free(rest, old_size - size);
+        tlsf_insert((node_t *)rest);
+    } else {
+        size = old_size;
+    }
+    blk_set_used(blk, size);
+    return (void *)((U32)blk + sizeof(header_T));
+}
+
+static int tlsf_dealloc(header_T *blk)
+{
+    U32 size = blk_size(blk);
+
+    header_T *next = blk_next_phys(blk);
+    if (!(next->size & MEM_BLK_USED)) {
+        tlsf_remove((node_t *)next);
+        size += blk_size(next);
+    }
+    if (blk->size & MEM_BLK_PREV_FREE) {
+        header_T *prev = blk_prev_phys(blk);
+        tlsf_remove((node_t *)prev);
+        size += blk_size(prev);
+        blk->size = 0;      // the stale header must not pass for a used block again
+        blk = prev;
+    }
+    blk_set_free(blk, size);
+    tlsf_insert((node_t *)blk);
+    return RTX_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * BUDDY: the heap is cut into power of two blocks aligned to their size,
+ * relative to the first heap block. The buddy of a block is found by
+ * flipping one offset bit, so merging on dealloc is a header compare per
+ * order. A used block keeps the rounded request in its size word, its
+ * block size is the next power of two.
+ *---------------------------------------------------------------------------
+ */
+
+static __inline U32 buddy_order(U32 size)
+{
+    return (size <= MEM_BLK_MIN) ? 0 : mem_fls(size - 1) + 1 - mem_fls(MEM_BLK_MIN);
+}
+
+static void buddy_insert(node_t *blk, U32 order)
+{
+    blk->size = MEM_BLK_MIN << order;
+    hist_add(NULL, blk->size);
+    blk->prev = NULL;
+    blk->next = buddy_lists[order];
+    if (blk->next != NULL) {
+        blk->next->prev = blk;
+    }
+    buddy_lists[order] = blk;
+    buddy_bitmap |= (1U << order);
+}
+
+static void buddy_remove(node_t *blk, U32 order)
+{
+    hist_sub(NULL, MEM_BLK_MIN << order);
+    if (blk->next != NULL) {
+        blk->next->prev = blk->prev;
+    }
+    if (blk->prev != NULL) {
+        blk->prev->next = blk->next;
+    } else {
+        buddy_lists[order] = blk->next;
+        if (blk->next == NULL) {
+            buddy_bitmap &= ~(1U << order);
+        }
+    }
+}
+
+static void buddy_init(U32 base, U32 len)
+{
+    U32 off = 0;
+
+    for (int order = 0; order < BUDDY_ORDERS; order++) {
+        buddy_lists[order] = NULL;
+    }
+    buddy_bitmap = 0;
+    buddy_waste = 0;
+
+    // largest aligned blocks first, none of them has a buddy inside the heap
+    while (len - off >= MEM_BLK_MIN) {
+        U32 order = mem_fls(len - off) - mem_fls(MEM_BLK_MIN);
+        if (order >= BUDDY_ORDERS) {
+            order = BUDDY_ORDERS - 1;
+        }
+        buddy_insert((node_t *)(base + off), order);
+        off += MEM_BLK_MIN << order;
+    }
+}
+
+static void *buddy_alloc(U32 size)
+{
+    U32 order = buddy_order(size);
+    U32 map = (order < BUDDY_ORDERS) ? buddy_bitmap & (~0U << order) : 0;
+    if (map == 0) {
+        return NULL;
+    }
+
+    U32 k = mem_ffs(map);
+    header_T *blk = (header_T *)buddy_lists[k];
+    buddy_remove((node_t *)blk, k);
+    while (k > order) {
+        k--;
+        buddy_insert((node_t *)((U32)blk + (MEM_BLK_MIN << k)), k);
+    }
+
+    blk->size = size | MEM_BLK_USED;
+    blk->task_id = mem_owner();
+    buddy_waste += (MEM_BLK_MIN << order) - size;
+    return (void *)((U32)blk + sizeof(header_T));
+}
+
+static int buddy_check(header_T *blk)
+{
+    U32 size = blk_size(blk);
+    U32 off = (U32)blk - ((U32)head + MEM_BLK_MIN);
+
+    if ((blk->size & MEM_BLK_FLAGS) != MEM_BLK_USED || size < MEM_BLK_MIN || size > heap_size) {
+        return FALSE;
+    }
+    U32 blk_len = MEM_BLK_MIN << buddy_order(size);
+    return (off & (blk_len - 1)) == 0 && off + blk_len <= heap_size;
+}
+
+static int buddy_dealloc(header_T *blk)
+{
+    U32 base = (U32)head + MEM_BLK_MIN;
+    U32 size = blk_size(blk);
+    U32 order = buddy_order(size);
+    U32 off = (U32)blk - base;
+
+    buddy_waste -= (MEM_BLK_MIN << order) - size;
+    blk->size = 0;          // the stale header must not pass for a used block again
+
+    while (order < BUDDY_ORDERS - 1) {
+        U32 blk_len = MEM_BLK_MIN << order;
+        U32 buddy_off = off ^ blk_len;
+        node_t *buddy = (node_t *)(base + buddy_off);
+
+        // a free buddy of the same order carries exactly blk_len, no flags
+        if (buddy_off + blk_len > heap_size || buddy->size != blk_len) {
+            break;
+        }
+        buddy_remove(buddy, order);
+        off &= ~blk_len;
+        order++;
+    }
+    buddy_insert((node_t *)(base + off), order);
+    return RTX_OK;
+}
+
+// a used block keeps its place, shrinking below its order frees the upper halves
+static void buddy_resize(header_T *blk, U32 size)
+{
+    U32 order = buddy_order(blk_size(blk));
+    U32 new_order = buddy_order(size);
+
+    if (new_order > order) {
+        return;
+    }
+    buddy_waste -= (MEM_BLK_MIN << order) - blk_size(blk);
+    // the buddy of every upper half is the used lower half, nothing merges
+    while (order > new_order) {
+        order--;
+        buddy_insert((node_t *)((U32)blk + (MEM_BLK_MIN << order)), order);
+    }
+    blk->size = size | MEM_BLK_USED;
+    buddy_waste += (MEM_BLK_MIN << order) - size;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * Task arenas: a task may reserve one heap block for its small requests.
+ * Blocks are cut from the front of the arena in power of two classes and
+ * recycled through one free stack per class, so a task never searches the
+ * shared heap for them. The whole arena goes back to the heap in one free
+ * when the task exits.
+ *---------------------------------------------------------------------------
+ */
+
+static __inline U32 arena_class(U32 size)
+{
+    return (size <= MEM_BLK_MIN) ? 0 : mem_fls(size - 1) + 1 - mem_fls(MEM_BLK_MIN);
+}
+
+static mem_arena_t *arena_of(void *ptr)
+{
+    mem_arena_t *arena = &mem_arenas[mem_owner()];
+
+    if (arena->start != 0 && (U32)ptr >= arena->start && (U32)ptr < arena->end) {
+        return arena;
+    }
+    return NULL;
+}
+
+static void *arena_alloc(U32 size)
+{
+    mem_arena_t *arena = &mem_arenas[mem_owner()];
+
+    size += sizeof(header_T);
+    if (arena->start == 0 || size > ARENA_MAX_BLK) {
+        return NULL;
+    }
+
+    U32 class = arena_class(size);
+    U32 blk_len = MEM_BLK_MIN << class;
+    header_T *blk = (header_T *)arena->free[class];
+    if (blk != NULL) {
+        arena->free[class] = arena->free[class]->next;
+    } else if (arena->top + blk_len <= arena->end) {
+        blk = (header_T *)arena->top;
+        arena->top += blk_len;
+    } else {
+        return NULL;
+    }
+
+    blk->size = blk_len | MEM_BLK_USED;
+    blk->task_id = mem_owner();
+    return (void *)((U32)blk + sizeof(header_T));
+}
+
+static int arena_check(mem_arena_t *arena, header_T *blk)
+{
+    U32 blk_len = blk_size(blk);
+
+    return (U32)blk >= arena->start && !((U32)blk & 0x7) &&
+           (blk->size & MEM_BLK_FLAGS) == MEM_BLK_USED && blk_owner(blk) == mem_owner() &&
+           blk_len >= MEM_BLK_MIN && blk_len <= ARENA_MAX_BLK && !(blk_len & (blk_len - 1)) &&
+           (U32)blk + blk_len <= arena->top;
+}
+
+static int arena_free(mem_arena_t *arena, void *ptr)
+{
+    header_T *blk = (header_T *)((U32)ptr - sizeof(header_T));
+    U32 blk_len = blk_size(blk);
+
+    if (!arena_check(arena, blk)) {
+        return RTX_ERR;
+    }
+
+    node_t *node = (node_t *)blk;
+    U32 class = arena_class(blk_len);
+    node->size = blk_len;
+    node->next = arena->free[class];
+    arena->free[class] = node;
+    return RTX_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * Slab layer: requests of up to SLAB_MAX_OBJ bytes are served from pages of
+ * equal sized objects without a header_T. A byte map at the front of each
+ * page holds the owner of the object starting in every 8 byte granule, so
+ * dealloc validates a pointer with a shift and a load, no division. Pages
+ * with free objects sit on a list per class and a page that empties goes
+ * back to the shared pool unless it is the last one of its class, so the
+ * classes can trade pages as the workload shifts.
+ *---------------------------------------------------------------------------
+ */
+
+#define SLAB_OBJ_OFF        ((sizeof(slab_t) + SLAB_GRANULES + 7) & ~0x7)
+
+static __inline U8 *slab_owner(slab_t *page, void *obj)
+{
+    return (U8 *)page + sizeof(slab_t) + (((U32)obj - (U32)page) >> 3);
+}
+
+static void slab_unlink(slab_t *page)
+{
+    if (page->next != NULL) {
+        page->next->prev = page->prev;
+    }
+    if (page->prev != NULL) {
+        page->prev->next = page->next;
+    } else {
+        slab_partial[page->class] = page->next;
+    }
+}
+
+static void slab_link(slab_t *page)
+{
+    page->prev = NULL;
+    page->next = slab_partial[page->class];
+    if (page->next != NULL) {
+        page->next->prev = page;
+    }
+    slab_partial[page->class] = page;
+}
+
+static slab_t *slab_new_page(U32 class)
+{
+    slab_t *page = slab_free_pages;
+    if (page == NULL) {
+        return NULL;
+    }
+    slab_free_pages = page->next;
+
+    U8 *map = slab_owner(page, page);
+    for (int i = 0; i < SLAB_GRANULES; i++) {
+        map[i] = SLAB_NONE;
+    }
+    page->free = NULL;
+    for (int i = slab_capacity[class] - 1; i >= 0; i--) {
+        void *obj = (void *)((U32)page + SLAB_OBJ_OFF + i * slab_obj_size[class]);
+        *(void **)obj = page->free;
+        page->free = obj;
+        *slab_owner(page, obj) = SLAB_FREE;
+    }
+    page->class = class;
+    page->in_use = 0;
+    slab_link(page);
+    slab_stats.pages[class]++;
+    return page;
+}
+
+static void *slab_alloc(U32 size)
+{
+    if (slab_start == 0 || size > SLAB_MAX_OBJ) {
+        return NULL;
+    }
+
+    U32 class = slab_class_of[(size + 7) >> 3];
+    slab_t *page = slab_partial[class];
+    if (page == NULL && (page = slab_new_page(class)) == NULL) {
+        return NULL;
+    }
+
+    void *obj = page->free;
+    page->free = *(void **)obj;
+    page->in_use++;
+    if (page->free == NULL) {
+        slab_unlink(page);
+    }
+    *slab_owner(page, obj) = mem_owner();
+    slab_stats.in_use[class]++;
+    return obj;
+}
+
+// the page of ptr if ptr starts an object of an active page held by the caller
+static slab_t *slab_check(void *ptr)
+{
+    slab_t *page = (slab_t *)((((U32)ptr - slab_start) & ~(SLAB_PAGE_SIZE - 1)) + slab_start);
+
+    if (page->in_use == 0 || ((U32)ptr & 0x7) || *slab_owner(page, ptr) != mem_owner()) {
+        return NULL;
+    }
+    return page;
+}
+
+static int slab_free(void *ptr)
+{
+    slab_t *page = slab_check(ptr);
+    if (page == NULL) {
+        return RTX_ERR;
+    }
+
+    U8 *owner = slab_owner(page, ptr);
+    U32 class = page->class;
+    *owner = SLAB_FREE;
+    *(void **)ptr = page->free;
+    page->free = ptr;
+    if (page->in_use-- == slab_capacity[class]) {
+        slab_link(page);
+    }
+    // keep the last page of a class so that a class going up and down by
+    // a few objects does not rebuild a page every time
+    if (page->in_use == 0 && (page->prev != NULL || page->next != NULL)) {
+        slab_unlink(page);
+        page->next = slab_free_pages;
+        slab_free_pages = page;
+        slab_stats.pages[class]--;
+    }
+    slab_stats.in_use[class]--;
+    return RTX_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * Task stacks, kernel and user, live in their own region at the top of RAM,
+ * outside the heap, so long lived stacks never sit between short lived
+ * messages. Stacks are cut from the bottom of the region in power of two
+ * classes when a task is created and recycled through one free stack per
+ * class when it exits. They carry no header because the TCB already records
+ * the size. Stacks above STK_MAX_SIZE, or any stack once the region is full,
+ * come from the heap.
+ *---------------------------------------------------------------------------
+ */
+
+static __inline U32 stk_class(U32 size)
+{
+    return (size <= STK_MIN_SIZE) ? 0 : mem_fls(size - 1) + 1 - mem_fls(STK_MIN_SIZE);
+}
+
+static void stk_init(U32 size)
+{
+    stk_start = 0;
+    stk_end = 0;
+    stk_top = 0;
+    stk_used = 0;
+    stk_peak_used = 0;
+    stk_spills = 0;
+    for (int i = 0; i < STK_CLASSES; i++) {
+        stk_free[i] = NULL;
+    }
+    if (size != 0) {
+        stk_end = RAM_END + 1;
+        stk_start = (stk_end - size) & ~0x7;
+        stk_top = stk_start;
+    }
+}
+
+static U32 *stk_alloc(U32 size)
+{
+    if (stk_start == 0 || size > STK_MAX_SIZE) {
+        return NULL;
+    }
+
+    U32 class = stk_class(size);
+    U32 stk_len = STK_MIN_SIZE << class;
+    U32 *stack = stk_free[class];
+    if (stack != NULL) {
+        stk_free[class] = (U32 *)*stack;
+    } else if (stk_top + stk_len <= stk_end) {
+        stack = (U32 *)stk_top;
+        stk_top += stk_len;
+    } else {
+        return NULL;
+    }
+
+    stk_used += stk_len;
+    if (stk_used > stk_peak_used) {
+        stk_peak_used = stk_used;
+    }
+    return stack;
+}
+
+static void stk_dealloc(U32 *stack, U32 size)
+{
+    U32 class = stk_class(size);
+
+    *stack = (U32)stk_free[class];
+    stk_free[class] = stack;
+    stk_used -= STK_MIN_SIZE << class;
+}
+
+// returns the top of a stack of size bytes, the stack grows down from there
+static U32 *stk_get(U32 size)
+{
+    size = (size + 7) & ~0x7;
+    U32 *stack = stk_alloc(size);
+
+    if (stack == NULL) {
+        // heap stacks belong to the null task so that no user task can free them
+        task_t tmpTID = gp_current_task->tid;
+        gp_current_task->tid = 0;
+        stack = k_mem_alloc(size);
+        gp_current_task->tid = tmpTID;
+        if (stack == NULL) {
+            return NULL;
+        }
+        stk_spills++;
+    }
+    if (MEM_STK_PAINT) {
+        for (U32 *word = stack; word < (U32 *)((U32)stack + size); word++) {
+            *word = STK_PAINT_WORD;
+        }
+    }
+    return (U32 *)((U32)stack + size);
+}
+
+static int stk_put(U32 *stack_hi, U32 size)
+{
+    if (stack_hi == NULL) {
+        return RTX_ERR;
+    }
+    size = (size + 7) & ~0x7;
+    U32 *stack = (U32 *)((U32)stack_hi - size);
+
+    if ((U32)stack >= stk_start && (U32)stack < stk_top) {
+        stk_dealloc(stack, size);
+        return RTX_OK;
+    }
+
+    task_t tmpTID = gp_current_task->tid;
+    gp_current_task->tid = 0;
+    int ret = k_mem_dealloc(stack);
+    gp_current_task->tid = tmpTID;
+    return ret;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * kernel memory API
+ *---------------------------------------------------------------------------
+ */
+
+U32 *k_alloc_k_stack(task_t tid, RTX_TASK_INFO *rtx_info)
 {
-    int size;
-    unsigned int task_id;
-} header_T;
+    U32 size = (rtx_info->k_stack_size < K_STACK_SIZE) ? K_STACK_SIZE : rtx_info->k_stack_size;
 
-typedef struct __node_t
-{
-    int size;
-    struct __node_t *next;
-} node_t;
+    return stk_get(size);
+}
 
-node_t *head;
-node_t* tail;
-unsigned int end_addr;
+U32 *k_alloc_p_stack(task_t tid, RTX_TASK_INFO *rtx_info)
+{   
+    return stk_get(rtx_info->u_stack_size);
+}
 
-U32 *k_alloc_k_stack(task_t tid)
+int k_dealloc_k_stack(U32 *stack_hi, U32 size)
 {
-    return g_k_stacks[tid + 1];
+    return stk_put(stack_hi, size);
 }
 
-U32 *k_alloc_p_stack(task_t tid, RTX_TASK_INFO *rtx_info)
-{   
-    task_t tmpTID = gp_current_task->tid;
-    gp_current_task->tid = 0;
+int k_dealloc_p_stack(U32 *stack_hi, U32 size)
+{
+    return stk_put(stack_hi, size);
+}
 
-    void* returnVal =(void *) ((U32) k_mem_alloc(rtx_info->u_stack_size) + rtx_info->u_stack_size);
+// bytes between the top of a painted stack and the deepest word written
+int k_mem_stack_usage(U32 *stack_hi, U32 size)
+{
+    if (!MEM_STK_PAINT || stack_hi == NULL) {
+        return RTX_ERR;
+    }
+    size = (size + 7) & ~0x7;
+    U32 *word = (U32 *)((U32)stack_hi - size);
 
-    gp_current_task->tid = tmpTID;
-    
-    return returnVal;
+    while (word < stack_hi && *word == STK_PAINT_WORD) {
+        word++;
+    }
+    return (U32)stack_hi - (U32)word;
 }
 
-int k_mem_init(void)
+// every init path ends here, and once tasks run the heap holds their
+// stacks, mailboxes and arenas, so it cannot be laid out again
+static int mem_init_heap(int algo)
 {
+    if (algo < FIXED_POOL || algo > BUDDY || gp_current_task != NULL) {
+        return RTX_ERR;
+    }
+    mem_algo = algo;
+    mem_num_pools = 0;
+    for (int i = 0; i < MEM_HIST_BUCKETS; i++) {
+        mem_free_hist[i] = 0;
+    }
+    mem_hist_bitmap = 0;
+    for (int i = 0; i < MEM_EXACT_SLOTS; i++) {
+        mem_exact_cnt[i] = 0;
+        mem_exact_tree[i + 1] = 0;
+    }
+    for (int i = 0; i < (MEM_EXACT_SLOTS >> 5); i++) {
+        mem_exact_map[i] = 0;
+    }
+    mem_exact_group = 0;
+    for (int fl = 0; fl < MEM_BIG_FL_COUNT; fl++) {
+        for (int sl = 0; sl < MEM_BIG_SL_COUNT; sl++) {
+            mem_big_lists[fl][sl] = NULL;
+            mem_big_last[fl][sl] = NULL;
+            mem_big_cnt[fl][sl] = 0;
+        }
+        mem_big_sl_map[fl] = 0;
+    }
+    mem_big_fl_map = 0;
+    g_mem_stats = (RTX_MEM_STATS) {0};
+    for (int i = 0; i < MAX_TASKS; i++) {
+        mem_arenas[i].start = 0;
+    }
+    slab_start = 0;
+    slab_end = 0;
 
-	 end_addr = (unsigned int)&Image$$ZI_DATA$$ZI$$Limit;
+	 end_addr = ((unsigned int)&Image$$ZI_DATA$$ZI$$Limit + 7) & ~0x7;
 #ifdef DEBUG_0
     printf("k_mem_init: image ends at 0x%x\r\n", end_addr);
     printf("k_mem_init: RAM ends at 0x%x\r\n", RAM_END);
 #endif /* DEBUG_0 */
 
     head = (node_t *)end_addr;
-    node_t *real_head = (node_t*)((U32)head + sizeof(node_t));
-    tail = (node_t*)((RAM_END + 1) - sizeof(node_t));
+    header_T *real_head = (header_T *)((U32)head + MEM_BLK_MIN);
+    // the user stack region, when there is one, is the top of RAM
+    tail = (node_t*)(((stk_start != 0) ? stk_start : RAM_END + 1) - MEM_BLK_MIN);
+
+    head->size = MEM_BLK_MIN | MEM_BLK_USED;
+    tail->size = MEM_BLK_USED;
+    heap_size = (U32)tail - (U32)real_head;
+
+    if (mem_algo == BUDDY) {
+        buddy_init((U32)real_head, heap_size);
+        return RTX_OK;
+    }
+
+    real_head->size = 0;
+    blk_set_free(real_head, heap_size);
 
-    head->size = sizeof(node_t);
-    tail->size = sizeof(node_t);
-    heap_size = tail - real_head;
-    real_head->size = heap_size;
+    if (mem_segregated()) {
+        tlsf_init();
+        tlsf_insert((node_t *)real_head);
+        return RTX_OK;
+    }
 
-    real_head->next = tail;
+    head->prev = NULL;
     tail->next = NULL;
-    head->next = real_head;
+    ff_link((node_t *)real_head, head, tail);
 
     return RTX_OK;
 }
 
+// lays out the heap with the policy in g_sys_info, which k_rtx_init_rt sets
+int k_mem_init(void)
+{
+    if (gp_current_task != NULL) {
+        return RTX_ERR;     // the stack region below is in use as well
+    }
+    stk_init(MEM_STK_REGION);
+    if (k_mem_init_algo(g_sys_info.mem_algo) != RTX_OK) {
+        return RTX_ERR;
+    }
+    // the FIXED_POOL pools already serve the small sizes the slab layer would take
+    return (MEM_SLAB && g_sys_info.mem_algo != FIXED_POOL) ? k_mem_slab_init() : RTX_OK;
+}
+
+int k_mem_slab_init(void)
+{
+    if (slab_start != 0) {
+        return RTX_ERR;
+    }
+    void *region = k_mem_alloc(SLAB_PAGES * SLAB_PAGE_SIZE);
+    if (region == NULL) {
+        return RTX_ERR;
+    }
 
+    for (int class = 0; class < SLAB_CLASSES; class++) {
+        U32 size = slab_obj_size[class];
+        U32 count = (SLAB_PAGE_SIZE - SLAB_OBJ_OFF) / size;
 
-void *k_mem_alloc(size_t size)
+        slab_capacity[class] = count;
+        slab_partial[class] = NULL;
+        slab_stats.obj_size[class] = size;
+        slab_stats.capacity[class] = count;
+        slab_stats.pages[class] = 0;
+        slab_stats.in_use[class] = 0;
+    }
+
+    slab_free_pages = NULL;
+    for (int i = SLAB_PAGES - 1; i >= 0; i--) {
+        slab_t *page = (slab_t *)((U32)region + i * SLAB_PAGE_SIZE);
+        page->in_use = 0;
+        page->next = slab_free_pages;
+        slab_free_pages = page;
+    }
+    slab_start = (U32)region;
+    slab_end = slab_start + SLAB_PAGES * SLAB_PAGE_SIZE;
+    return RTX_OK;
+}
+
+int k_mem_init_algo(int algo)
+{
+    if (algo == FIXED_POOL) {
+        return k_mem_init_pool(g_mem_pool_info, sizeof(g_mem_pool_info) / sizeof(MEM_POOL_INFO));
+    }
+    return mem_init_heap(algo);
+}
+
+int k_mem_init_pool(MEM_POOL_INFO *pools, int num_pools)
 {
+    if (pools == NULL || num_pools < 1 || num_pools > MEM_MAX_POOLS) {
+        return RTX_ERR;
+    }
+    if (mem_init_heap(FIXED_POOL) != RTX_OK) {
+        return RTX_ERR;
+    }
+
+    for (int i = 0; i < num_pools; i++) {
+        if (pools[i].blk_size == 0 || pools[i].blk_count == 0 ||
+            (i > 0 && pools[i].blk_size <= pools[i - 1].blk_size)) {
+            mem_num_pools = 0;
+            return RTX_ERR;
+        }
+
+        mem_pool_t *pool = &mem_pools[i];
+        pool->blk_size = (pools[i].blk_size + 7) & ~0x7;
+        pool->stride = pool->blk_size + sizeof(header_T);
+        // the pool region is the payload of one used first-fit block
+        pool->start = (U32)ff_alloc(pool->stride * pools[i].blk_count + sizeof(header_T));
+        if (pool->start == 0) {
+            mem_num_pools = 0;
+            return RTX_ERR;
+        }
+        pool->end = pool->start + pool->stride * pools[i].blk_count;
+        pool->free = NULL;
+        pool->num_free = 0;
+
+        // push from the top so that the lowest block is handed out first
+        for (U32 blk = pool->end - pool->stride; blk >= pool->start; blk -= pool->stride) {
+            pool_free(pool, (header_T *)blk);
+        }
+        mem_num_pools++;
+    }
+    return RTX_OK;
+}
+
+// bytes a live block takes out of the heap, header included
+static U32 mem_blk_bytes(header_T *blk)
+{
+    if (mem_algo == BUDDY) {
+        return MEM_BLK_MIN << buddy_order(blk_size(blk));
+    }
+    return blk_size(blk);   // pool blocks carry their stride
+}
+
+// the largest free block ends the list of the top size class, or is the top exact slot
+static U32 mem_largest_free(void)
+{
+    if (mem_hist_bitmap == 0) {
+        return 0;
+    }
+    if (mem_algo == BUDDY) {
+        return 1U << mem_fls(mem_hist_bitmap);
+    }
+    if (mem_big_fl_map != 0) {
+        U32 fl = mem_fls(mem_big_fl_map);
+        return big_size(mem_big_last[fl][mem_fls(mem_big_sl_map[fl])]);
+    }
+    U32 word = mem_fls(mem_exact_group);
+    return ((word << 5) + mem_fls(mem_exact_map[word])) << 3;
+}
+
+static void *mem_alloc_blk(size_t size)
+{
+    if (mem_algo == FIXED_POOL) {
+        void *ptr = pool_alloc(size);
+        if (ptr != NULL) {
+            return ptr;
+        }
+    }
 
-#ifdef DEBUG_0
-//    printf("k_mem_alloc: requested memory size = %d\r\n", size);
-#endif /* DEBUG_0 */
 	size += sizeof(header_T);
     int remainder = size % 8;
     size = (remainder == 0) ? size : (size + 8 - remainder);
+    size = (size < MEM_BLK_MIN) ? MEM_BLK_MIN : size;
 
 
    if (size > heap_size) 
@@ -162,39 +1533,212 @@ void *k_mem_alloc(size_t size)
        return NULL;
    }
 
-    node_t *currNode = head->next;
-    node_t *prevNode = head;
+    if (mem_algo == BUDDY) {
+        return buddy_alloc(size);
+    }
+    if (mem_segregated()) {
+        return tlsf_alloc(size);
+    }
+    return ff_alloc(size);
+}
+
+// the payload an aligned pointer was cut from, NULL if the tag is not the caller's
+static void *mem_untag(void *ptr, U32 *offset)
+{
+    header_T *tag = (header_T *)((U32)ptr - sizeof(header_T));
+
+    *offset = 0;
+    if ((tag->size & MEM_BLK_FLAGS) != MEM_BLK_ALIGNED) {
+        return ptr;
+    }
+    if (tag->task_id != mem_owner() || blk_size(tag) >= (U32)ptr - (U32)head) {
+        return NULL;
+    }
+    *offset = blk_size(tag);
+    return (void *)((U32)ptr - *offset);
+}
+
+static int mem_dealloc_blk(void *ptr)
+{
+    U32 offset;
 
-    while (currNode != tail)
+    if ((U32)ptr >= (U32)tail || (U32)ptr <= (U32)head || ((U32)ptr & 0x7))
     {
-        if (currNode->size >= size)
-        {
-        	node_t *tempNext = currNode->next;
-        	U32 oldSize = currNode->size;
-
-        	header_T *memBlockHeader = (header_T *)currNode;
-            memBlockHeader->size = size;
-            memBlockHeader->task_id = gp_current_task->tid; 
-
-			// if(oldSize > size + sizeof(header_T))
-            if(oldSize > size)
-			{
-				node_t *newFreeBlock = (node_t *)((U32)memBlockHeader + size);
-				newFreeBlock->size = oldSize - size;
-				prevNode->next = newFreeBlock;
-				newFreeBlock->next = tempNext;
-			}
-			else
-			{
-				memBlockHeader->size = oldSize;
-				prevNode->next = tempNext;
-			}
-            return (void *)((U32)memBlockHeader + sizeof(header_T));
-        }
-		prevNode = currNode;
-		currNode = currNode->next;
+        return RTX_ERR;
     }
-    return NULL;
+    ptr = mem_untag(ptr, &offset);
+    if (ptr == NULL) {
+        return RTX_ERR;
+    }
+    header_T *header = (header_T*)((U32)ptr - sizeof(header_T));
+
+    if (mem_algo == FIXED_POOL && (header->size & MEM_BLK_POOL)) {
+        mem_pool_t *pool = pool_of(header);
+        if (pool == NULL || !(header->size & MEM_BLK_USED) || mem_owner() != blk_owner(header)) {
+            return RTX_ERR;
+        }
+        g_mem_stats.used -= mem_blk_bytes(header);
+        pool_free(pool, header);
+        return RTX_OK;
+    }
+
+    if (mem_algo == BUDDY) {
+        if (!buddy_check(header) || mem_owner() != blk_owner(header)) {
+            return RTX_ERR;
+        }
+        g_mem_stats.used -= mem_blk_bytes(header);
+        return buddy_dealloc(header);
+    }
+
+    if (!blk_check(header) || mem_owner() != blk_owner(header))
+    {
+        return RTX_ERR;
+    }
+
+    g_mem_stats.used -= mem_blk_bytes(header);
+    if (mem_segregated()) {
+        return tlsf_dealloc(header);
+    }
+    return ff_dealloc(header);
+}
+
+/*
+ * Resizes a used heap block in place: a shrink splits off the tail and frees
+ * it, a grow absorbs the free block behind. Blocks of the policies with
+ * boundary tags only, the block is left alone when neither works.
+ */
+static void heap_resize(header_T *blk, U32 size)
+{
+    U32 old_size = blk_size(blk);
+    U32 flags = (U32)blk->size & MEM_BLK_FLAGS;
+    header_T *next = blk_next_phys(blk);
+
+    if (size <= old_size) {
+        if (old_size - size >= MEM_BLK_MIN) {
+            header_T *rest = (header_T *)((U32)blk + size);
+            blk->size = size | flags;
+            rest->size = (old_size - size) | MEM_BLK_USED;
+            // merges with a free block behind, never with blk in front
+            if (mem_segregated()) {
+                tlsf_dealloc(rest);
+            } else {
+                ff_dealloc(rest);
+            }
+        }
+        return;
+    }
+
+    if ((next->size & MEM_BLK_USED) || old_size + blk_size(next) < size) {
+        return;
+    }
+    U32 total = old_size + blk_size(next);
+    node_t *prev = ((node_t *)next)->prev;
+    node_t *after = ((node_t *)next)->next;
+
+    if (mem_segregated()) {
+        tlsf_remove((node_t *)next);
+    } else {
+        hist_sub(next, blk_size(next));
+    }
+    if (total - size >= MEM_BLK_MIN) {
+        header_T *rest = (header_T *)((U32)blk + size);
+        blk->size = size | flags;
+        rest->size = 0;
+        blk_set_free(rest, total - size);
+        if (mem_segregated()) {
+            tlsf_insert((node_t *)rest);
+        } else {
+            ff_link((node_t *)rest, prev, after);   // rest takes the place of next
+        }
+    } else {
+        if (!mem_segregated()) {
+            ff_unlink((node_t *)next);
+        }
+        blk->size = total | flags;
+        blk_next_phys(blk)->size &= ~MEM_BLK_PREV_FREE;
+    }
+}
+
+// payload bytes of a heap block after resizing it in place where possible, 0 for a bad pointer
+static U32 mem_resize_blk(void *ptr, size_t size)
+{
+    U32 offset;
+
+    if ((U32)ptr >= (U32)tail || (U32)ptr <= (U32)head || ((U32)ptr & 0x7)) {
+        return 0;
+    }
+    ptr = mem_untag(ptr, &offset);
+    if (ptr == NULL) {
+        return 0;
+    }
+    header_T *header = (header_T *)((U32)ptr - sizeof(header_T));
+
+    if (mem_algo == FIXED_POOL && (header->size & MEM_BLK_POOL)) {
+        if (pool_of(header) == NULL || !(header->size & MEM_BLK_USED) || mem_owner() != blk_owner(header)) {
+            return 0;
+        }
+        return blk_size(header) - sizeof(header_T) - offset;
+    }
+
+    size += sizeof(header_T);
+    size = (size + 7) & ~0x7;
+    size = (size < MEM_BLK_MIN) ? MEM_BLK_MIN : size;
+
+    if (mem_algo == BUDDY) {
+        if (!buddy_check(header) || mem_owner() != blk_owner(header)) {
+            return 0;
+        }
+    } else if (!blk_check(header) || mem_owner() != blk_owner(header)) {
+        return 0;
+    }
+    // an aligned payload stays put, growing it past its block means a move
+    if (offset != 0) {
+        return mem_blk_bytes(header) - sizeof(header_T) - offset;
+    }
+
+    g_mem_stats.used -= mem_blk_bytes(header);
+    if (mem_algo == BUDDY) {
+        buddy_resize(header, size);
+    } else {
+        heap_resize(header, size);
+    }
+    g_mem_stats.used += mem_blk_bytes(header);
+    if (g_mem_stats.used > g_mem_stats.peak_used) {
+        g_mem_stats.peak_used = g_mem_stats.used;
+    }
+    return mem_blk_bytes(header) - sizeof(header_T);
+}
+
+void *k_mem_alloc(size_t size)
+{
+
+#ifdef DEBUG_0
+//    printf("k_mem_alloc: requested memory size = %d\r\n", size);
+#endif /* DEBUG_0 */
+    // arena blocks were counted as used when the arena was made
+    void *ptr = arena_alloc(size);
+    if (ptr != NULL) {
+        g_mem_stats.num_allocs++;
+        return ptr;
+    }
+
+    ptr = slab_alloc(size);
+    if (ptr != NULL) {
+        g_mem_stats.num_allocs++;
+        return ptr;
+    }
+
+    ptr = mem_alloc_blk(size);
+    if (ptr == NULL) {
+        g_mem_stats.num_alloc_fails++;
+        return NULL;
+    }
+    g_mem_stats.num_allocs++;
+    g_mem_stats.used += mem_blk_bytes((header_T *)((U32)ptr - sizeof(header_T)));
+    if (g_mem_stats.used > g_mem_stats.peak_used) {
+        g_mem_stats.peak_used = g_mem_stats.used;
+    }
+    return ptr;
 }
 
 int k_mem_dealloc(void *ptr)
@@ -203,80 +1747,269 @@ int k_mem_dealloc(void *ptr)
     printf("k_mem_dealloc: freeing 0x%x\r\n", (U32)ptr);
 #endif /* DEBUG_0 */
 
-    if ((U32)ptr >= (U32)tail || (U32)ptr <= (U32)head || ((U32)ptr &0x3))
-    {
-        return RTX_ERR;
+    mem_arena_t *arena = arena_of(ptr);
+    int ret;
+
+    if (arena != NULL) {
+        ret = arena_free(arena, ptr);
+    } else if ((U32)ptr >= slab_start && (U32)ptr < slab_end) {
+        ret = slab_free(ptr);
+    } else {
+        ret = mem_dealloc_blk(ptr);
     }
-    node_t *currNode = head->next;
-    node_t *prevNode = head;
-    header_T *header = (header_T*)((U32)ptr - sizeof(header_T));
 
-    if (gp_current_task->tid != header->task_id)
-    {
+    if (ret != RTX_OK) {
+        g_mem_stats.num_free_fails++;
         return RTX_ERR;
     }
+    g_mem_stats.num_frees++;
+    return RTX_OK;
+}
 
-    while((U32)header > (U32)currNode){
-    		prevNode = currNode;
-    		currNode = currNode->next;
+/*
+ * The block is allocated align bytes larger than asked. With boundary tags
+ * a gap of at least MEM_BLK_MIN in front of the aligned payload is split off
+ * and freed, the one free fragment this can cost, and the tail is trimmed
+ * only where it merges with a free block behind. Otherwise the gap stays in
+ * the block and an aligned tag in front of the payload records it.
+ */
+void *k_mem_alloc_aligned(size_t size, size_t align)
+{
+#ifdef DEBUG_0
+    printf("k_mem_alloc_aligned: size = %d, align = %d\r\n", size, align);
+#endif /* DEBUG_0 */
+    if (align <= 8) {
+        return (align != 0 && (align & (align - 1)) == 0) ? k_mem_alloc(size) : NULL;
+    }
+    if ((align & (align - 1)) || size + align < size) {
+        return NULL;
     }
 
-    if((U32)header == (U32)currNode){
-    	return RTX_ERR;
+    void *raw = mem_alloc_blk(size + align);
+    if (raw == NULL) {
+        g_mem_stats.num_alloc_fails++;
+        return NULL;
     }
+    header_T *blk = (header_T *)((U32)raw - sizeof(header_T));
+    U32 ptr = ((U32)raw + align - 1) & ~(align - 1);
+    U32 gap = ptr - (U32)raw;
+
+    if (gap >= MEM_BLK_MIN && mem_algo != BUDDY && !(blk->size & MEM_BLK_POOL)) {
+        header_T *front = blk;
+        U32 total = blk_size(front);
 
-    U32 startingAddr = (U32)prevNode + prevNode->size;
-    while(startingAddr < (U32)header){
-    	startingAddr = startingAddr + ((header_T*)startingAddr)->size;
+        blk = (header_T *)(ptr - sizeof(header_T));
+        blk->size = (total - gap) | MEM_BLK_USED;
+        blk->task_id = mem_owner();
+        front->size = gap | MEM_BLK_USED | ((U32)front->size & MEM_BLK_PREV_FREE);
+        // blk is used, so front can only merge with a free block before it
+        if (mem_segregated()) {
+            tlsf_dealloc(front);
+        } else {
+            ff_dealloc(front);
+        }
+        if (!(blk_next_phys(blk)->size & MEM_BLK_USED)) {
+            U32 need = (size + sizeof(header_T) + 7) & ~0x7;
+            heap_resize(blk, (need < MEM_BLK_MIN) ? MEM_BLK_MIN : need);
+        }
+    } else if (gap != 0) {
+        header_T *tag = (header_T *)(ptr - sizeof(header_T));
+        tag->size = gap | MEM_BLK_ALIGNED;
+        tag->task_id = mem_owner();
     }
+    blk->task_id |= mem_fls(align) << MEM_ALIGN_SHIFT;     // for k_mem_realloc to keep
 
-    if(startingAddr > (U32)header){
-    	return RTX_ERR;
+    g_mem_stats.num_allocs++;
+    g_mem_stats.used += mem_blk_bytes(blk);
+    if (g_mem_stats.used > g_mem_stats.peak_used) {
+        g_mem_stats.peak_used = g_mem_stats.used;
     }
+    return (void *)ptr;
+}
 
-   U32 tempHeaderSize = header->size;
-//   printf("the header size is %u\n", tempHeaderSize);
-   node_t *newFreeBlock = (node_t *)header;
-   prevNode->next = newFreeBlock;
-   newFreeBlock->next = currNode;
-   newFreeBlock->size = tempHeaderSize;
+// alignment a valid heap or slab pointer was allocated with, at least 8
+static U32 mem_align_of(void *ptr)
+{
+    U32 offset;
 
-   if(currNode != tail) {
-	   if((U32)newFreeBlock + newFreeBlock->size == (U32)currNode){
-		   newFreeBlock->size = newFreeBlock->size + currNode->size;
-		   prevNode->next = newFreeBlock;
-		   newFreeBlock->next = currNode->next;
-	   }
-   }
+    if ((U32)ptr >= slab_start && (U32)ptr < slab_end) {
+        return 8;
+    }
+    header_T *blk = (header_T *)((U32)mem_untag(ptr, &offset) - sizeof(header_T));
+    U32 shift = blk->task_id >> MEM_ALIGN_SHIFT;
+    return (shift == 0) ? 8 : (1U << shift);
+}
 
-   if(prevNode != head) {
-	   if((U32)prevNode + prevNode->size == (U32)newFreeBlock){
-		   prevNode->size = prevNode->size + newFreeBlock->size;
-		   prevNode->next = newFreeBlock->next;
-	   }
-   }
-   return RTX_OK;
+void *k_mem_realloc(void *ptr, size_t size)
+{
+#ifdef DEBUG_0
+    printf("k_mem_realloc: resizing 0x%x to %d\r\n", (U32)ptr, size);
+#endif /* DEBUG_0 */
+    if (ptr == NULL) {
+        return k_mem_alloc(size);
+    }
+
+    // bytes the block can hold once resized in place, 0 if ptr is not the caller's block
+    mem_arena_t *arena = arena_of(ptr);
+    U32 avail;
+    if (arena != NULL) {
+        header_T *blk = (header_T *)((U32)ptr - sizeof(header_T));
+        avail = arena_check(arena, blk) ? blk_size(blk) - sizeof(header_T) : 0;
+    } else if ((U32)ptr >= slab_start && (U32)ptr < slab_end) {
+        slab_t *page = slab_check(ptr);
+        avail = (page != NULL) ? slab_obj_size[page->class] : 0;
+    } else {
+        avail = mem_resize_blk(ptr, size);
+    }
+
+    // a bad pointer is not an allocation that failed
+    if (avail == 0) {
+        return NULL;
+    }
+    if (size <= avail) {
+        g_mem_stats.num_realloc_in_place++;
+        return ptr;
+    }
+
+    // the old block stays valid when there is no room for the new one
+    U32 align = (arena == NULL) ? mem_align_of(ptr) : 8;
+    void *new_ptr = (align > 8) ? k_mem_alloc_aligned(size, align) : k_mem_alloc(size);
+    if (new_ptr == NULL) {
+        return NULL;
+    }
+    for (U32 i = 0; i < (avail >> 2); i++) {
+        ((U32 *)new_ptr)[i] = ((U32 *)ptr)[i];
+    }
+    k_mem_dealloc(ptr);
+    g_mem_stats.num_realloc_copies++;
+    return new_ptr;
+}
+
+int k_mem_arena_create(size_t size)
+{
+#ifdef DEBUG_0
+    printf("k_mem_arena_create: size = %d\r\n", size);
+#endif /* DEBUG_0 */
+
+    mem_arena_t *arena = &mem_arenas[mem_owner()];
+
+    if (arena->start != 0 || size < ARENA_MAX_BLK) {
+        return RTX_ERR;
+    }
+    void *region = k_mem_alloc(size);
+    if (region == NULL) {
+        return RTX_ERR;
+    }
+
+    arena->start = (U32)region;
+    arena->end = ((U32)region + size) & ~0x7;
+    arena->top = arena->start;
+    for (int i = 0; i < ARENA_CLASSES; i++) {
+        arena->free[i] = NULL;
+    }
+    return RTX_OK;
+}
+
+int k_mem_arena_release(task_t tid)
+{
+    mem_arena_t *arena = &mem_arenas[tid];
+    void *region = (void *)arena->start;
+
+    // the region is owned by tid, so only tid itself can hand it back
+    if (region == NULL || mem_owner() != tid) {
+        return RTX_ERR;
+    }
+    arena->start = 0;
+    return k_mem_dealloc(region);
 }
 
+/*
+ * Free blocks smaller than size, from the counts kept by hist_add and
+ * hist_sub. Below MEM_EXACT_MAX the answer is a Fenwick prefix sum. Above
+ * it whole classes are added up, and only the class size falls in is
+ * walked, from its smallest block up to the first one of size or more.
+ */
 int k_mem_count_extfrag(size_t size)
 {
 #ifdef DEBUG_0
     printf("k_mem_extfrag: size = %d\r\n", size);
 #endif /* DEBUG_0 */
 
+    // no free block is below MEM_BLK_MIN and the top bucket is always empty
+    if (size <= MEM_BLK_MIN) {
+        return 0;
+    }
+    U32 bucket = mem_fls(size);
     int counter = 0;
-    node_t *currNode = head->next;
-    while (currNode != tail)
-    {
-        if (currNode->size < size)
-        {
-            counter++;
+
+    // free sizes are powers of two, a whole bucket is on one side of size
+    if (mem_algo == BUDDY) {
+        for (int i = 0; i < bucket; i++) {
+            counter += mem_free_hist[i];
         }
-        currNode = currNode->next;
+        return (size == (1U << bucket)) ? counter : counter + mem_free_hist[bucket];
+    }
+
+    // sizes are multiples of 8, the ones below size fill the slots below ceil(size / 8)
+    if (size <= MEM_EXACT_MAX) {
+        return exact_below((size + 7) >> 3);
+    }
+    counter = exact_below(MEM_EXACT_SLOTS);
+    for (int i = MEM_EXACT_LOG2; i < bucket; i++) {
+        counter += mem_free_hist[i];
+    }
+    U32 fl, sl;
+    big_class(size, &fl, &sl);
+    for (int i = 0; i < sl; i++) {
+        counter += mem_big_cnt[fl][i];
+    }
+    // the class of size is the only one with blocks on both sides of it
+    for (mem_big_t *link = mem_big_lists[fl][sl]; link != NULL && big_size(link) < size; link = link->next) {
+        counter++;
     }
     return counter;
 }
 
+int k_mem_stats(RTX_MEM_STATS *buffer)
+{
+    if (buffer == NULL) {
+        return RTX_ERR;
+    }
+    *buffer = g_mem_stats;
+    buffer->heap_size = heap_size;
+    buffer->largest_free = mem_largest_free();
+    buffer->stack_size = stk_end - stk_start;
+    buffer->stack_used = stk_used;
+    buffer->stack_peak_used = stk_peak_used;
+    buffer->stack_spills = stk_spills;
+    return RTX_OK;
+}
+
+int k_mem_slab_stats(RTX_SLAB_STATS *buffer)
+{
+    if (buffer == NULL || slab_start == 0) {
+        return RTX_ERR;
+    }
+    *buffer = slab_stats;
+    return RTX_OK;
+}
+
+int k_mem_get_stats(RTX_MEM_HIST *buffer)
+{
+    if (buffer == NULL) {
+        return RTX_ERR;
+    }
+    for (int i = 0; i < MEM_HIST_BUCKETS; i++) {
+        buffer->free_blks[i] = mem_free_hist[i];
+    }
+    return RTX_OK;
+}
+
+int k_mem_count_intfrag(void)
+{
+    return (mem_algo == BUDDY) ? buddy_waste : RTX_ERR;
+}
+
 /*
  *===========================================================================
  *                             END OF FILE
@@ -43,17 +43,63 @@
 #define K_MEM_H_
 #include "k_inc.h"
 
+/*
+ * ------------------------------------------------------------------------
+ *                             MACROS
+ * ------------------------------------------------------------------------
+ */
+#ifndef MEM_ALGO
+#define MEM_ALGO            FIRST_FIT   /* heap policy when no RTX_SYS_INFO is given */
+#endif
+#define MEM_MAX_POOLS       8           /* pools FIXED_POOL can manage    */
+#ifndef MEM_SLAB
+#define MEM_SLAB            FALSE       /* k_mem_init puts the slab layer in front */
+#endif
+#ifndef MEM_STK_REGION
+/* bytes for task stacks at the top of RAM, as much as the static stacks of
+   MAX_TASKS tasks took out of the image, stacks that do not fit spill to the heap */
+#define MEM_STK_REGION      (MAX_TASKS * (K_STACK_SIZE + U_STACK_SIZE))
+#endif
+#ifndef MEM_STK_PAINT
+#define MEM_STK_PAINT       FALSE       /* paint new stacks so their depth can be measured */
+#endif
+
+/*
+ * ------------------------------------------------------------------------
+ *                             TYPEDEFS
+ * ------------------------------------------------------------------------
+ */
+typedef struct mem_pool_info
+{
+    U32 blk_size;       /* largest request in bytes a block can serve */
+    U32 blk_count;      /* number of blocks reserved for the pool     */
+} MEM_POOL_INFO;
+
 /*
  * ------------------------------------------------------------------------
  *                             FUNCTION PROTOTYPES
  * ------------------------------------------------------------------------
  */
 int     k_mem_init          (void);
+int     k_mem_init_algo     (int algo);
+int     k_mem_init_pool     (MEM_POOL_INFO *pools, int num_pools);
+int     k_mem_slab_init     (void);
 void   *k_mem_alloc         (size_t size);
 int     k_mem_dealloc       (void *ptr);
+void   *k_mem_realloc       (void *ptr, size_t size);
+void   *k_mem_alloc_aligned (size_t size, size_t align);
 int     k_mem_count_extfrag (size_t size);
-U32    *k_alloc_k_stack     (task_t tid);
+int     k_mem_arena_create  (size_t size);
+int     k_mem_arena_release (task_t tid);
+int     k_mem_count_intfrag (void);
+int     k_mem_stats         (RTX_MEM_STATS *buffer);
+int     k_mem_slab_stats    (RTX_SLAB_STATS *buffer);
+int     k_mem_get_stats     (RTX_MEM_HIST *buffer);
+U32    *k_alloc_k_stack     (task_t tid, RTX_TASK_INFO *rtx_info);
 U32    *k_alloc_p_stack     (task_t tid, RTX_TASK_INFO *rtx_info);
+int     k_dealloc_k_stack   (U32 *stack_hi, U32 size);
+int     k_dealloc_p_stack   (U32 *stack_hi, U32 size);
+int     k_mem_stack_usage   (U32 *stack_hi, U32 size);
 #endif // ! K_MEM_H_
 
 /*
@@ -23,8 +23,8 @@ void create_mailbox(size_t size, mailbox_queue* mailbox_addr) {
         return;
     }
 
-    // allocate memory for the buffer
-    mailbox_addr->buffer = k_mem_alloc(size);
+    // allocate memory for the buffer, the ring gets cache lines of its own
+    mailbox_addr->buffer = k_mem_alloc_aligned(size, CACHE_LINE_SIZE);
     gp_current_task->tid = tmpTID;
 }
 
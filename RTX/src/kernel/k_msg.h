@@ -10,6 +10,7 @@
 
 #include "k_rtx.h"
 
+void create_mailbox(size_t size, mailbox_queue* mailbox_addr);
 int k_mbx_create(size_t size);
 int k_send_msg(task_t receiver_tid, const void *buf);
 int k_recv_msg(task_t *sender_tid, void *buf, size_t len);
@@ -44,12 +44,18 @@
 #include "k_mem.h"
 #include "k_task.h"
 
+RTX_SYS_INFO g_sys_info;        // system configuration, DEFAULT until k_rtx_init_rt
+
 int k_rtx_init(RTX_TASK_INFO *task_info, int num_tasks)
 {
+    if (g_sys_info.rtx_time_qtm == 0) {
+        g_sys_info.rtx_time_qtm = MIN_RTX_QTM;
+        g_sys_info.mem_algo = MEM_ALGO;
+    }
     // Initialize UART0 Rx interrupts
     UART0_Init();
-    // Set HPS0 timer to count down from
-    config_hps_timer(0,10000,1,1);
+    // HPS0 timer ticks every rtx_time_qtm us, each tick is a scheduling point
+    config_hps_timer(0, g_sys_info.rtx_time_qtm * HPS_TIMER_MHZ, 1, 0);
     // Set A9 timer to count down from 0xFFFFFFFF every 1 us
     // With this setting, A9 timer resets every ~1.2 hrs
     config_a9_timer(0xFFFFFFFF,1,0,199);
@@ -70,13 +76,47 @@ int k_rtx_init(RTX_TASK_INFO *task_info, int num_tasks)
 
 int k_rtx_init_rt(RTX_SYS_INFO *sys_info, RTX_TASK_INFO *task_info, int num_tasks)
 {
+    if (sys_info == NULL) {
+        return RTX_ERR;
+    }
+    // the tick is a whole number of MIN_RTX_QTM and must fit the HPS timer
+    if (sys_info->sched != DEFAULT && sys_info->sched != RM_PS &&
+        sys_info->sched != RM_NPS && sys_info->sched != EDF) {
+        return RTX_ERR;
+    }
+    if (sys_info->mem_algo > BUDDY) {
+        return RTX_ERR;
+    }
+    if (sys_info->rtx_time_qtm < MIN_RTX_QTM || sys_info->rtx_time_qtm % MIN_RTX_QTM != 0 ||
+        sys_info->rtx_time_qtm > 0xFFFFFFFFU / HPS_TIMER_MHZ) {
+        return RTX_ERR;
+    }
+    // the server period is a whole number of ticks and holds its budget
+    if (sys_info->sched == RM_PS) {
+        TIMEVAL *p_n = &sys_info->server.p_n;
+        TIMEVAL *b_n = &sys_info->server.b_n;
+        if (p_n->sec >= 4000 || p_n->usec >= 1000000 || b_n->sec >= 2000 || b_n->usec >= 1000000) {
+            return RTX_ERR;
+        }
+        U32 period_us = p_n->sec * 1000000 + p_n->usec;
+        U32 budget_us = b_n->sec * 1000000 + b_n->usec;
+        if (period_us == 0 || period_us % sys_info->rtx_time_qtm != 0 ||
+            budget_us == 0 || budget_us > period_us) {
+            return RTX_ERR;
+        }
+    }
+
     /* initialize the scheduler here */
-    k_rtx_init(task_info, num_tasks);
-    return RTX_OK;
+    g_sys_info = *sys_info;
+    return k_rtx_init(task_info, num_tasks);
 }
 
 int k_get_sys_info(RTX_SYS_INFO *buffer)
 {
+    if (buffer == NULL) {
+        return RTX_ERR;
+    }
+    *buffer = g_sys_info;
     return RTX_OK;
 }
 
@@ -53,6 +53,8 @@
  */
 
 int k_rtx_init  (RTX_TASK_INFO *task_info, int num_tasks);
+int k_rtx_init_rt(RTX_SYS_INFO *sys_info, RTX_TASK_INFO *task_info, int num_tasks);
+int k_get_sys_info(RTX_SYS_INFO *buffer);
 
 #endif /* ! K_RTX_INIT_H_ */
 
@@ -52,6 +52,9 @@
 #include "Serial.h"
 #include "k_task.h"
 #include "k_rtx.h"
+#include "k_msg.h"
+#include "k_timer.h"
+#include "timer.h"
 
 //#define DEBUG_0
 
@@ -78,7 +81,73 @@ RTX_TASK_INFO   g_null_task_info;			// The null task info
 U32             g_num_active_tasks = 0;		// number of non-dormant tasks
 U32 registered_commands[223];
 node_t *head_tid;
-static TCB* head_task;
+
+/*
+ * Ready queue: one FIFO of TCBs per priority level and a bitmap with one bit
+ * per level. Level p is bit 31 - (p & 31) of word p >> 5, so the highest
+ * priority, the lowest number, is the leftmost set bit and one CLZ finds it.
+ * g_ready_group marks the words with a bit set the same way. The running
+ * task stays at the front of its queue until it blocks, yields or exits.
+ */
+#define PRIO_LEVELS         256
+
+static TCB *g_ready_head[PRIO_LEVELS];
+static TCB *g_ready_tail[PRIO_LEVELS];
+static U32  g_ready_bitmap[PRIO_LEVELS >> 5];
+static U32  g_ready_group;
+
+static U32  g_slice_left;       // ticks left of the running task's time slice
+
+U32         g_rtx_ticks;        // rtx_time_qtm ticks since k_rtx_init
+
+/*
+ * Under EDF the ready real-time jobs sit in a binary min-heap of TCBs
+ * ordered by rt_deadline instead of the PRIO_RT queue, and the earliest
+ * deadline is at the root. Slots are 1-based so heap_idx == 0 means "not in
+ * the heap". Tasks waiting for their next period sit in the timing wheel.
+ */
+typedef struct tcb_heap {
+    TCB *item[MAX_TASKS + 1];
+    U32  size;
+} tcb_heap;
+
+static tcb_heap g_edf_heap;
+
+// tick counts wrap, compare them by their distance instead
+#define TICK_BEFORE(a, b)   ((S32)((a) - (b)) < 0)
+
+/*
+ * Polling server of RM_PS. Under rate-monotonic scheduling the real-time
+ * tasks take the levels between PRIO_RT and HIGH, shorter periods first.
+ * The tasks at HIGH and below only run inside the server, which competes
+ * at g_server_prio, the level its own period earns, while it has budget.
+ * The budget is charged from the A9 timer at every scheduling point and
+ * refilled at the start of each server period. A server with budget but
+ * nothing to serve loses the budget for the rest of its period.
+ */
+static U8   g_server_prio;
+static U32  g_server_period;    // in ticks
+static U32  g_server_release;   // tick of the next replenishment
+static S32  g_server_budget;    // in us, may overrun by up to one tick
+static U32  g_server_stamp;     // A9 timer value at the last charge
+
+static U32  ready_first(U32 from);
+
+// Liu-Layland bound n(2^(1/n) - 1) in parts per million, ln 2 beyond 10 tasks
+static const U32 g_ll_bound[] = {
+    1000000, 828427, 779763, 756828, 743492, 734772, 728627, 724062, 720538, 717735
+};
+#define LL_BOUND_INF        693147
+
+/*
+ * k_tsk_exit runs on the kernel stack it gives up, and a stack that spilled
+ * to the heap gets a boundary tag and free list links the moment it is
+ * freed. So the exiting task only leaves its stack here, and the next
+ * k_tsk_exit or task creation, both on another stack, hands it back.
+ */
+static U32  g_exit_stack_hi;
+static U32  g_exit_stack_size;
+
 extern void kcd_task(void);
 
 
@@ -87,41 +156,19 @@ extern void kcd_task(void);
 The memory map of the OS image may look like the following:
 
                        RAM_END+---------------------------+ High Address
-                              |                           |
+                              |   kernel and user stacks  |
+                              |   of the created tasks    |
+                              |   (MEM_STK_REGION bytes)  |
+                  stk_start-->|---------------------------|
                               |                           |
                               |    Free memory space      |
-                              |   (user space stacks      |
-                              |         + heap            |
-                              |                           |
+                              |         (heap)            |
                               |                           |
                               |                           |
  &Image$$ZI_DATA$$ZI$$Limit-->|---------------------------|-----+-----
                               |         ......            |     ^
                               |---------------------------|     |
-                              |      U_STACK_SIZE         |     |
-             g_p_stacks[15]-->|---------------------------|     |
-                              |                           |     |
-                              |  other kernel proc stacks |     |
-                              |---------------------------|     |
-                              |      U_STACK_SIZE         |  OS Image
-              g_p_stacks[2]-->|---------------------------|     |
-                              |      U_STACK_SIZE         |     |
-              g_p_stacks[1]-->|---------------------------|     |
-                              |      U_STACK_SIZE         |     |
-              g_p_stacks[0]-->|---------------------------|     |
-                              |   other  global vars      |     |
-                              |                           |  OS Image
-                              |---------------------------|     |
-                              |      K_STACK_SIZE         |     |                
-             g_k_stacks[15]-->|---------------------------|     |
-                              |                           |     |
-                              |     other kernel stacks   |     |                              
-                              |---------------------------|     |
                               |      K_STACK_SIZE         |  OS Image
-              g_k_stacks[2]-->|---------------------------|     |
-                              |      K_STACK_SIZE         |     |                      
-              g_k_stacks[1]-->|---------------------------|     |
-                              |      K_STACK_SIZE         |     |
               g_k_stacks[0]-->|---------------------------|     |
                               |   other  global vars      |     |
                               |---------------------------|     |
@@ -153,57 +200,305 @@ The memory map of the OS image may look like the following:
 
 TCB *scheduler(void) 
 {
-    return head_task;
+    if (g_edf_heap.size != 0) {
+        return g_edf_heap.item[1];
+    }
+    U32 prio = ready_first(PRIO_RT);
+
+    if (g_sys_info.sched == RM_PS) {
+        U32 served = ready_first(HIGH);
+        if (served < PRIO_NULL && g_server_budget > 0 && g_server_prio < prio) {
+            return g_ready_head[served];
+        }
+        // the rest waits for the next server period, only the null task is left
+        if (prio >= HIGH) {
+            prio = PRIO_NULL;
+        }
+    }
+    return (prio < PRIO_LEVELS) ? g_ready_head[prio] : NULL;
 }
 
 //SCHEDULER QUEUE IMPLEMENTAION (read over)
 
-void add_task (TCB *task)
+// the highest ready priority level at or below from, PRIO_LEVELS if none
+static U32 ready_first(U32 from)
 {
-    TCB *temp = head_task;
-
-    if(temp->prio > task->prio){
-        task->next = temp;
-        head_task = task;
-    }
-    else{
-        while (temp->next != NULL)
-        {
-            if (temp->next->prio > task->prio)
-            {
-                TCB temp2 = *temp;
-                temp->next = task;
-                task->next = temp2.next;
-                break;
+    U32 group = from >> 5;
+    U32 bits = g_ready_bitmap[group] & (0xFFFFFFFFU >> (from & 31));
+
+    if (bits != 0) {
+        return (group << 5) + __clz(bits);
+    }
+    // only the words after this one
+    bits = g_ready_group & ((0xFFFFFFFFU >> group) >> 1);
+    if (bits == 0) {
+        return PRIO_LEVELS;
+    }
+    group = __clz(bits);
+    return (group << 5) + __clz(g_ready_bitmap[group]);
+}
+
+// true for the tasks that only run inside the polling server
+static int server_task(TCB *task)
+{
+    return g_sys_info.sched == RM_PS && task->prio >= HIGH && task->prio != PRIO_NULL;
+}
+
+// charge the time since the last scheduling point to the server
+static void server_charge(void)
+{
+    U32 now = timer_get_current_val(2);     // counts down, 1 us per tick
+
+    if (gp_current_task != NULL && server_task(gp_current_task)) {
+        g_server_budget -= (S32)(g_server_stamp - now);
+    }
+    g_server_stamp = now;
+}
+
+/*
+ * Job timing of the real-time tasks. Releases are not stamped when they
+ * happen, a job is released exactly one period after the one before, so a
+ * late timer interrupt counts as release jitter instead of moving the
+ * release. Only the first release is read from the timers.
+ */
+
+// the next job of a real-time task is released
+static void rt_job_release(TCB *job)
+{
+    U32 period_us = job->rt_period * g_sys_info.rtx_time_qtm;
+
+    job->rt_stats.release -= period_us;     // the A9 timer counts down
+    job->rt_stats.deadline = job->rt_stats.release - period_us;
+    job->rt_stats.start = 0;
+    job->rt_started = 0;
+}
+
+// a job is dispatched for the first time
+static void rt_job_start(TCB *job)
+{
+    U32 now = timer_get_current_val(2);
+    U32 jitter = job->rt_stats.release - now;
+
+    job->rt_stats.start = now;
+    job->rt_started = 1;
+    if (jitter > job->rt_stats.max_jitter) {
+        job->rt_stats.max_jitter = jitter;
+    }
+}
+
+// a job calls tsk_done_rt
+static void rt_job_finish(TCB *job)
+{
+    U32 now = timer_get_current_val(2);
+    U32 response = job->rt_stats.release - now;
+
+    job->rt_stats.finish = now;
+    job->rt_stats.jobs++;
+    if (response > job->rt_stats.max_response) {
+        job->rt_stats.max_response = response;
+    }
+    if ((S32)(now - job->rt_stats.deadline) < 0) {
+        job->rt_stats.misses++;
+    }
+}
+
+/*
+ * Scheduling histograms of SCHED_HIST, one pair per priority level. A task
+ * is stamped when it is queued while not running, and its wake-to-run
+ * latency is taken when it is switched in. The switch cost runs from just
+ * before k_tsk_switch to the return on the new task's stack, so tasks that
+ * start at their entry point for the first time are not counted.
+ */
+#if SCHED_HIST
+static RTX_SCHED_HIST g_sched_hist[PRIO_LEVELS];
+static U32 g_switch_stamp;      // A9 timer count before the last k_tsk_switch
+
+// bucket of a time in us, log2 rounded down plus one
+static U32 hist_bucket(U32 us)
+{
+    U32 bucket = (us == 0) ? 0 : 32 - __clz(us);
+
+    return (bucket < SCHED_HIST_BUCKETS) ? bucket : SCHED_HIST_BUCKETS - 1;
+}
+#endif
+
+/*
+ * Rate-monotonic levels: a real-time task sits one level below PRIO_RT for
+ * every task with a shorter period, the polling server included. Tasks of
+ * equal period share a level, and the order holds as tasks exit, so this
+ * only runs when a task is created.
+ */
+static void rm_assign_prio(void)
+{
+    U32 server = (g_sys_info.sched == RM_PS) ? g_server_period : 0;
+    U32 rank;
+
+    rank = 0;
+    for (int i = 1; i < MAX_TASKS; i++) {
+        if (g_tcbs[i].rt_period != 0 && g_tcbs[i].rt_period < server) {
+            rank++;
+        }
+    }
+    g_server_prio = (rank < HIGH - 1) ? rank + 1 : HIGH - 1;
+
+    for (int i = 1; i < MAX_TASKS; i++) {
+        TCB *task = &g_tcbs[i];
+        if (task->rt_period == 0) {
+            continue;
+        }
+        rank = (server != 0 && server < task->rt_period) ? 1 : 0;
+        for (int j = 1; j < MAX_TASKS; j++) {
+            if (g_tcbs[j].rt_period != 0 && g_tcbs[j].rt_period < task->rt_period) {
+                rank++;
             }
-            temp = temp->next;
         }
+        U8 prio = (rank < HIGH - 1) ? rank + 1 : HIGH - 1;
+        if (task->prio == prio) {
+            continue;
+        }
+        if (task->state == READY || task->state == RUNNING) {
+            remove_task(task->tid);
+            task->prio = prio;
+            add_task(task);
+        } else {
+            task->prio = prio;
+        }
+    }
+}
+
+static void heap_set(tcb_heap *heap, U32 i, TCB *task)
+{
+    heap->item[i] = task;
+    task->heap_idx = i;
+}
+
+// move the task in slot i up or down until the heap order holds again
+static void heap_fix(tcb_heap *heap, U32 i)
+{
+    TCB *task = heap->item[i];
+
+    while (i > 1 && TICK_BEFORE(task->rt_deadline, heap->item[i >> 1]->rt_deadline)) {
+        heap_set(heap, i, heap->item[i >> 1]);
+        i >>= 1;
+    }
+    for (;;) {
+        U32 child = i << 1;
+        if (child > heap->size) {
+            break;
+        }
+        if (child < heap->size &&
+            TICK_BEFORE(heap->item[child + 1]->rt_deadline, heap->item[child]->rt_deadline)) {
+            child++;
+        }
+        if (!TICK_BEFORE(heap->item[child]->rt_deadline, task->rt_deadline)) {
+            break;
+        }
+        heap_set(heap, i, heap->item[child]);
+        i = child;
+    }
+    heap_set(heap, i, task);
+}
+
+static void heap_push(tcb_heap *heap, TCB *task)
+{
+    heap_set(heap, ++heap->size, task);
+    heap_fix(heap, heap->size);
+}
+
+static void heap_remove(tcb_heap *heap, TCB *task)
+{
+    U32 i = task->heap_idx;
+    TCB *last = heap->item[heap->size--];
+
+    task->heap_idx = 0;
+    if (last != task) {
+        heap_set(heap, i, last);
+        heap_fix(heap, i);
+    }
+}
+
+// frees the kernel stack the last exiting task left behind, if any
+static void tsk_reap_stack(void)
+{
+    if (g_exit_stack_hi != 0) {
+        k_dealloc_k_stack((U32 *)g_exit_stack_hi, g_exit_stack_size);
+        g_exit_stack_hi = 0;
+    }
+}
+
+// append task to the queue of its priority, behind the tasks already there
+void add_task (TCB *task)
+{
+    U8 prio = task->prio;
+
+#if SCHED_HIST
+    if (task->state != RUNNING && !task->hist_woken) {
+        task->hist_wake = timer_get_current_val(2);
+        task->hist_woken = 1;
+    }
+#endif
+    if (task->rt_period != 0 && g_sys_info.sched == EDF) {
+        task->next = NULL;
+        task->prev = NULL;
+        heap_push(&g_edf_heap, task);
+        return;
+    }
+
+    task->next = NULL;
+    task->prev = g_ready_tail[prio];
+    if (task->prev != NULL) {
+        task->prev->next = task;
+    } else {
+        g_ready_head[prio] = task;
     }
+    g_ready_tail[prio] = task;
+    g_ready_bitmap[prio >> 5] |= 0x80000000U >> (prio & 31);
+    g_ready_group |= 0x80000000U >> (prio >> 5);
 }
 
+// take a task out of its queue, a task that is not queued is left alone
 void remove_task(task_t tid)
 {
-    TCB *temp = head_task;
+    if (tid == TID_KCD && MAX_TASKS <= TID_KCD) {
+        tid = MAX_TASKS - 1;
+    }
+    TCB *task = &g_tcbs[tid];
+    U8 prio = task->prio;
 
-    if (temp->tid == tid)
-    {
-    	head_task = head_task->next;
+    if (task->heap_idx != 0) {
+        heap_remove(&g_edf_heap, task);
+        return;
     }
-    else
-    {
-    	while (temp->next != NULL)
-    	{
-    		if(temp->next->tid == tid){
-            temp->next = temp->next->next;
-            return;
+    if (task->prev == NULL && g_ready_head[prio] != task) {
+        return;
+    }
+    if (task->prev != NULL) {
+        task->prev->next = task->next;
+    } else {
+        g_ready_head[prio] = task->next;
+    }
+    if (task->next != NULL) {
+        task->next->prev = task->prev;
+    } else {
+        g_ready_tail[prio] = task->prev;
+    }
+    task->next = NULL;
+    task->prev = NULL;
+
+    if (g_ready_head[prio] == NULL) {
+        g_ready_bitmap[prio >> 5] &= ~(0x80000000U >> (prio & 31));
+        if (g_ready_bitmap[prio >> 5] == 0) {
+            g_ready_group &= ~(0x80000000U >> (prio >> 5));
         }
-      temp = temp->next;
     }
-   }
 }
 
+// TID nodes belong to the null task, any task creating or exiting may free one
 void insert_node(int tid){
+    TCB *self = gp_current_task;
+    gp_current_task = NULL;
     node_t* newNode = k_mem_alloc(sizeof(node_t));
+    gp_current_task = self;
     newNode->next = head_tid->next;
     head_tid->next = newNode;
     newNode->tid = tid;
@@ -213,7 +508,10 @@ int remove_node(){
     node_t* tempNode = head_tid->next;
     int tid = tempNode->tid;
     head_tid->next = tempNode->next;
+    TCB *self = gp_current_task;
+    gp_current_task = NULL;
     k_mem_dealloc(tempNode);
+    gp_current_task = self;
     return tid;
 }
 
@@ -253,12 +551,32 @@ int k_tsk_init(RTX_TASK_INFO *task_info, int num_tasks)
     p_tcb->priv     = 1;
     p_tcb->tid      = TID_NULL;
     p_tcb->state    = RUNNING;
-    p_tcb->next = NULL;
     p_tcb->mailbox.max_size = RAM_END;
     p_tcb->mailbox.trigger = 0;
+    p_tcb->k_stack_hi = (U32)g_k_stacks + K_STACK_SIZE;
+    p_tcb->k_stack_size = K_STACK_SIZE;
     g_num_active_tasks++;
     gp_current_task = p_tcb;
-    head_task = gp_current_task;
+    for (int i = 0; i < PRIO_LEVELS; i++) {
+        g_ready_head[i] = NULL;
+        g_ready_tail[i] = NULL;
+    }
+    for (int i = 0; i < (PRIO_LEVELS >> 5); i++) {
+        g_ready_bitmap[i] = 0;
+    }
+    g_ready_group = 0;
+    g_edf_heap.size = 0;
+    g_rtx_ticks = 0;
+    k_timer_init(g_rtx_ticks);
+    if (g_sys_info.sched == RM_PS) {
+        POLLING_SERVER *server = &g_sys_info.server;
+        g_server_period = (server->p_n.sec * 1000000 + server->p_n.usec) / g_sys_info.rtx_time_qtm;
+        g_server_release = g_server_period;
+        g_server_budget = server->b_n.sec * 1000000 + server->b_n.usec;
+        g_server_prio = 1;
+        g_server_stamp = timer_get_current_val(2);
+    }
+    add_task(p_tcb);
 
     int tid_kcd = (MAX_TASKS <= TID_KCD) ? (MAX_TASKS - 1) : TID_KCD;
     int k = (MAX_TASKS <= TID_KCD) ? MAX_TASKS - 2 : MAX_TASKS - 1;
@@ -327,11 +645,14 @@ int k_tsk_create_new(RTX_TASK_INFO *p_taskinfo, TCB *p_tcb, task_t tid)
         return RTX_ERR;
     }
 
-    if (g_num_active_tasks >= MAX_TASKS || p_taskinfo->ptask == NULL || p_taskinfo->prio == PRIO_NULL || p_taskinfo->prio == PRIO_RT || p_taskinfo->priv > 1)
+    // PRIO_RT is only for k_tsk_create_rt_wcet, which sets the period first
+    if (g_num_active_tasks >= MAX_TASKS || p_taskinfo->ptask == NULL || p_taskinfo->prio == PRIO_NULL ||
+        (p_taskinfo->prio == PRIO_RT && p_tcb->rt_period == 0) || p_taskinfo->priv > 1)
     {
     	return RTX_ERR; 
     }
 
+    tsk_reap_stack();
     p_tcb ->tid = tid;
     p_tcb->state = READY;
     if(tid == TID_KCD && MAX_TASKS <= TID_KCD){
@@ -343,8 +664,12 @@ int k_tsk_create_new(RTX_TASK_INFO *p_taskinfo, TCB *p_tcb, task_t tid)
      *         stacks grows down, stack base is at the high address
      * -------------------------------------------------------------*/
 
-    ///////sp = g_k_stacks[tid] + (K_STACK_SIZE >> 2) ;
-    sp = k_alloc_k_stack(tid);
+    sp = k_alloc_k_stack(tid, p_taskinfo);
+    if (sp == NULL) {
+        return RTX_ERR;
+    }
+    p_tcb->k_stack_hi = (U32)sp;
+    p_tcb->k_stack_size = (p_taskinfo->k_stack_size < K_STACK_SIZE) ? K_STACK_SIZE : p_taskinfo->k_stack_size;
 
     // 8B stack alignment adjustment
     if ((U32)sp & 0x04) {   // if sp not 8B aligned, then it must be 4B aligned
@@ -372,10 +697,13 @@ int k_tsk_create_new(RTX_TASK_INFO *p_taskinfo, TCB *p_tcb, task_t tid)
         // PC contains the entry point of the user/privileged task
         *(--sp) = (U32) (p_taskinfo->ptask);
 
-        //********************************************************************//
-        //*** allocate user stack from the user space, not implemented yet ***//
-        //********************************************************************//
+        // user stack from the stack region, see k_alloc_p_stack
         *(--sp) =  g_tcbs[tid].user_stack_ptr = (U32) k_alloc_p_stack(tid, p_taskinfo);
+        if (g_tcbs[tid].user_stack_ptr == 0) {
+            k_dealloc_k_stack((U32 *)p_tcb->k_stack_hi, p_tcb->k_stack_size);
+            return RTX_ERR;
+        }
+        g_tcbs[tid].u_stack_size = p_taskinfo->u_stack_size;
         
         // uR12, uR11, ..., uR0
         for ( int j = 0; j < 13; j++ ) {
@@ -465,6 +793,9 @@ int k_tsk_run_new(void)
     }
 
     p_tcb_old = gp_current_task;
+    if (g_sys_info.sched == RM_PS) {
+        server_charge();
+    }
     gp_current_task = scheduler();
 
     
@@ -472,14 +803,29 @@ int k_tsk_run_new(void)
         gp_current_task = p_tcb_old;        // revert back to the old task
         return RTX_ERR;
     }
+    if (gp_current_task->rt_period != 0 && !gp_current_task->rt_started) {
+        rt_job_start(gp_current_task);
+    }
 
     // at this point, gp_current_task != NULL and p_tcb_old != NULL
     if (gp_current_task != p_tcb_old) {
+        g_slice_left = RR_SLICE;            // a full slice for the switched-in task
         gp_current_task->state = RUNNING;   // change state of the to-be-switched-in  tcb
-        if(p_tcb_old->state != BLK_MSG){
+        if (p_tcb_old->state == RUNNING) {
             p_tcb_old->state = READY;           // change state of the to-be-switched-out tcb
         }
+#if SCHED_HIST
+        g_switch_stamp = timer_get_current_val(2);
+        if (gp_current_task->hist_woken) {
+            gp_current_task->hist_woken = 0;
+            g_sched_hist[gp_current_task->prio].wake_lat[hist_bucket(gp_current_task->hist_wake - g_switch_stamp)]++;
+        }
+#endif
         k_tsk_switch(p_tcb_old);            // switch stacks
+#if SCHED_HIST
+        // back on this task's stack, it is the one switched in
+        g_sched_hist[gp_current_task->prio].switch_cost[hist_bucket(g_switch_stamp - timer_get_current_val(2))]++;
+#endif
     }
 
     return RTX_OK;
@@ -497,20 +843,130 @@ int k_tsk_run_new(void)
  *****************************************************************************/
 int k_tsk_yield(void)
 {
-    if (gp_current_task->prio < gp_current_task->next->prio)
-    {
-        return RTX_OK;
+    TCB *temp = gp_current_task;
+
+    // go behind the other tasks of the same priority, if there are any
+    if (temp->next != NULL) {
+        remove_task(temp->tid);
+        add_task(temp);
     }
+    return k_tsk_run_new();
+}
 
-    if(gp_current_task->prio == PRIO_NULL){
-    	return k_tsk_run_new();
+// move the clock on by ticks, more than one after an idle stretch
+static void tick_advance(U32 ticks)
+{
+    g_rtx_ticks += ticks;
+    if (g_sys_info.sched == RM_PS) {
+        server_charge();
+        // a long idle stretch can skip whole server periods
+        while (!TICK_BEFORE(g_rtx_ticks, g_server_release)) {
+            POLLING_SERVER *server = &g_sys_info.server;
+            g_server_release += g_server_period;
+            g_server_budget = server->b_n.sec * 1000000 + server->b_n.usec;
+        }
     }
+    // wake the sleepers and release the jobs whose time is up
+    k_timer_run(g_rtx_ticks);
+    // polling: the server's turn came with nobody to serve
+    if (g_sys_info.sched == RM_PS && g_server_budget > 0 &&
+        ready_first(HIGH) >= PRIO_NULL && ready_first(PRIO_RT) > g_server_prio) {
+        g_server_budget = 0;
+    }
+}
+
+/**************************************************************************//**
+ * @brief       advance the RTX clock by one tick
+ * @return      1 when the running task has to give up the CPU, because a
+ *              released job or the end of its time slice put another task
+ *              first, 0 otherwise
+ * @note        called from the HPS timer 0 interrupt, the caller switches
+ *              to the next task with k_tsk_run_new when this returns 1
+ *****************************************************************************/
+int k_tsk_tick(void)
+{
     TCB *temp = gp_current_task;
-    remove_task(gp_current_task->tid);
-    add_task(temp);
-    int code  = k_tsk_run_new();
 
-    return code;
+    tick_advance(1);
+
+    if (temp == NULL) {
+        return 0;
+    }
+    // jobs in the EDF heap run to completion, the rest share their level
+    if (g_slice_left != 0 && --g_slice_left == 0 && temp->heap_idx == 0) {
+        g_slice_left = RR_SLICE;
+        if (temp->next != NULL) {
+            remove_task(temp->tid);
+            add_task(temp);
+        }
+    }
+    return scheduler() != temp;
+}
+
+
+/**************************************************************************//**
+ * @brief       stop the periodic tick and wait for an interrupt
+ * @pre         called by the null task
+ * @note        Only when nothing else is ready. HPS timer 0 is loaded to
+ *              expire on the next tick the timing wheel has work for, and
+ *              its reload count stays one tick, so the periodic tick comes
+ *              back by itself after that expiry. An earlier interrupt ends
+ *              the wait, the ticks that passed are accounted for and the
+ *              timer goes back to the periodic tick, in phase.
+ * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+ * @attention   CRITICAL SECTION
+ * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+ *****************************************************************************/
+void k_tsk_idle(void)
+{
+#if TICKLESS_IDLE
+    U32 period = g_sys_info.rtx_time_qtm * HPS_TIMER_MHZ;
+    U32 ticks;
+    U32 count;
+    U32 left;
+
+    __atomic_on();
+    left = timer_get_current_val(0);
+    // a tick that is due or about to be is taken the ordinary way
+    if (scheduler() != gp_current_task || timer_get_irq(0) || left < TICKLESS_GUARD) {
+        __atomic_off();
+        return;
+    }
+    ticks = k_timer_next(0xFFFFFFFFU / period);
+    // a served task may be waiting for the budget
+    if (g_sys_info.sched == RM_PS && g_server_release - g_rtx_ticks < ticks) {
+        ticks = g_server_release - g_rtx_ticks;
+    }
+    if (ticks < 2) {
+        __atomic_off();
+        return;
+    }
+
+    // the rest of this tick and the whole ones up to the wake-up tick
+    count = left + (ticks - 1) * period;
+    timer_disable(0);
+    timer_set_count(0, count);
+    timer_enable(0);
+    timer_set_count(0, period);     // takes effect at the reload
+    __wfi();
+
+    if (timer_get_irq(0)) {
+        // slept through, the pending interrupt is the wake-up tick
+        ticks -= 1;
+    } else {
+        left = timer_get_current_val(0);
+        ticks = (left / period < ticks - 1) ? ticks - 1 - left / period : 0;
+        left %= period;
+        timer_disable(0);
+        timer_set_count(0, (left == 0) ? period : left);
+        timer_enable(0);
+        timer_set_count(0, period);
+    }
+    if (ticks != 0) {
+        tick_advance(ticks);
+    }
+    __atomic_off();                 // the interrupt that woke us is taken here
+#endif
 }
 
 
@@ -551,10 +1007,18 @@ int k_tsk_create(task_t *task, void (*task_entry)(void), U8 prio, U16 stack_size
     g_tcbs[*(task)].priv = 0;
     g_tcbs[*(task)].ptask = task_entry;
     g_tcbs[*(task)].u_stack_size = stack_size;
+    g_tcbs[*(task)].rt_period = 0;
 
     g_num_active_tasks++; 
 
     int code = k_tsk_create_new(&rtx_task_info,  &g_tcbs[*(task)], *task);
+    if (code != RTX_OK) {
+        // no room for the stack, hand the TID back
+        g_tcbs[*(task)].state = DORMANT;
+        g_num_active_tasks--;
+        insert_node(*task);
+        return RTX_ERR;
+    }
 
     k_tsk_run_new();
     return code;
@@ -572,10 +1036,7 @@ void k_tsk_exit(void)
         return;
     }
     if(!(gp_current_task->priv)){
-        task_t tmpTID = gp_current_task->tid;
-        gp_current_task->tid = 0;
-        k_mem_dealloc((void *)gp_current_task->user_stack_ptr);
-        gp_current_task->tid = tmpTID;
+        k_dealloc_p_stack((U32 *)gp_current_task->user_stack_ptr, gp_current_task->u_stack_size);
     }
 
     gp_current_task->state = DORMANT;
@@ -583,8 +1044,15 @@ void k_tsk_exit(void)
 
     //mailbox free
     k_mem_dealloc(gp_current_task->mailbox.buffer);
+    // everything the task left in its arena goes back in one free
+    k_mem_arena_release(gp_current_task->tid);
+    // still running on this stack, it is handed back once another task runs
+    tsk_reap_stack();
+    g_exit_stack_hi = gp_current_task->k_stack_hi;
+    g_exit_stack_size = gp_current_task->k_stack_size;
     insert_node(gp_current_task->tid);
     remove_task(gp_current_task->tid);
+    gp_current_task->rt_period = 0;
     k_tsk_run_new();
 
     return;
@@ -607,13 +1075,19 @@ int k_tsk_set_prio(task_t task_id, U8 prio)
         return RTX_ERR;
     }
 
-    if(g_tcbs[task_id].state == DORMANT){
+    // real-time tasks are ordered by the scheduler, not by priority
+    if(g_tcbs[task_id].state == DORMANT || g_tcbs[task_id].rt_period != 0){
         return RTX_ERR;
     }
 
-    g_tcbs[task_id].prio = prio;
-    remove_task(task_id);
-    add_task(&g_tcbs[task_id]);
+    // only queued tasks move to the queue of the new priority
+    if (g_tcbs[task_id].state == READY || g_tcbs[task_id].state == RUNNING) {
+        remove_task(task_id);
+        g_tcbs[task_id].prio = prio;
+        add_task(&g_tcbs[task_id]);
+    } else {
+        g_tcbs[task_id].prio = prio;
+    }
     
     k_tsk_run_new();
     return RTX_OK;    
@@ -637,12 +1111,43 @@ int k_tsk_get_info(task_t task_id, RTX_TASK_INFO *buffer)
     buffer->state = g_tcbs[task_id].state;
     buffer->priv = g_tcbs[task_id].priv;
     buffer->ptask = g_tcbs[task_id].ptask;
-    buffer->k_stack_size = K_STACK_SIZE;
+    buffer->k_stack_hi = g_tcbs[task_id].k_stack_hi;
+    buffer->u_stack_hi = g_tcbs[task_id].user_stack_ptr;
+    buffer->k_stack_size = g_tcbs[task_id].k_stack_size;
     buffer->u_stack_size = g_tcbs[task_id].u_stack_size;
+    if (g_tcbs[task_id].rt_period != 0) {
+        U32 period_us = g_tcbs[task_id].rt_period * g_sys_info.rtx_time_qtm;
+        buffer->p_n.sec = period_us / 1000000;
+        buffer->p_n.usec = period_us % 1000000;
+        buffer->rt_mbx_size = g_tcbs[task_id].mailbox.trigger ? g_tcbs[task_id].mailbox.max_size : 0;
+    }
 
     return RTX_OK;     
 }
 
+int k_tsk_get_stack_usage(task_t task_id, RTX_STK_USAGE *buffer)
+{
+#ifdef DEBUG_0
+    printf("k_tsk_get_stack_usage: task_id = %d, buffer = 0x%x.\n\r", task_id, buffer);
+#endif /* DEBUG_0 */
+    // the null task runs on the boot stack, which is never painted
+    if (buffer == NULL || !MEM_STK_PAINT || task_id == TID_NULL || task_id >= MAX_TASKS ||
+        g_tcbs[task_id].state == DORMANT) {
+        return RTX_ERR;
+    }
+    TCB *p_tcb = &g_tcbs[task_id];
+
+    buffer->k_stack_size = p_tcb->k_stack_size;
+    buffer->k_stack_used = k_mem_stack_usage((U32 *)p_tcb->k_stack_hi, p_tcb->k_stack_size);
+    buffer->u_stack_size = 0;
+    buffer->u_stack_used = 0;
+    if (p_tcb->priv == 0) {
+        buffer->u_stack_size = p_tcb->u_stack_size;
+        buffer->u_stack_used = k_mem_stack_usage((U32 *)p_tcb->user_stack_ptr, p_tcb->u_stack_size);
+    }
+    return RTX_OK;
+}
+
 task_t k_tsk_get_tid(void)
 {
 #ifdef DEBUG_0
@@ -667,16 +1172,234 @@ int k_tsk_ls(task_t *buf, int count){
  *===========================================================================
  */
 
+/**************************************************************************//**
+ * @brief       admission test for a new periodic task
+ * @param       period  period of the new task in us
+ * @param       wcet    worst-case job time of the new task in us
+ * @return      RTX_OK if the real-time tasks, the new one and the polling
+ *              server included, stay schedulable, RTX_ERR otherwise
+ * @note        EDF admits up to 100% utilization. The RM schedulers admit
+ *              under the Liu-Layland bound and fall back to an exact
+ *              response-time analysis above it, counting tasks of equal
+ *              period as interference. Tasks created without a WCET add
+ *              nothing to the test, DEFAULT admits everything.
+ *****************************************************************************/
+static int rt_admit(U32 period, U32 wcet)
+{
+    static U32 t[MAX_TASKS + 1];    // periods in us, kernel stacks are small
+    static U32 c[MAX_TASKS + 1];    // worst-case job times in us
+    U32 qtm = g_sys_info.rtx_time_qtm;
+    U32 util = 0;
+    U32 n = 0;
+
+    if (wcet > period) {
+        return RTX_ERR;
+    }
+    if (g_sys_info.sched == DEFAULT) {
+        return RTX_OK;
+    }
+
+    t[n] = period;
+    c[n++] = wcet;
+    for (int i = 1; i < MAX_TASKS; i++) {
+        if (g_tcbs[i].rt_period != 0) {
+            t[n] = g_tcbs[i].rt_period * qtm;
+            c[n++] = g_tcbs[i].rt_wcet;
+        }
+    }
+    if (g_sys_info.sched == RM_PS) {
+        t[n] = g_server_period * qtm;
+        c[n++] = g_sys_info.server.b_n.sec * 1000000 + g_sys_info.server.b_n.usec;
+    }
+    for (U32 i = 0; i < n; i++) {
+        util += (U32)(((U64)c[i] * 1000000 + t[i] - 1) / t[i]);
+    }
+    if (util > 1000000) {
+        return RTX_ERR;
+    }
+    if (g_sys_info.sched == EDF || util <= ((n <= 10) ? g_ll_bound[n - 1] : LL_BOUND_INF)) {
+        return RTX_OK;
+    }
+
+    // R = C_i + sum of ceil(R / T_j) * C_j over the tasks j that can preempt i
+    for (U32 i = 0; i < n; i++) {
+        U64 r = c[i];
+        U64 prev = 0;
+        while (r != prev && r <= t[i]) {
+            prev = r;
+            r = c[i];
+            for (U32 j = 0; j < n; j++) {
+                if (j != i && t[j] <= t[i]) {
+                    r += ((prev + t[j] - 1) / t[j]) * c[j];
+                }
+            }
+        }
+        if (r > t[i]) {
+            return RTX_ERR;
+        }
+    }
+    return RTX_OK;
+}
+
 int k_tsk_create_rt(task_t *tid, TASK_RT *task)
 {
-    return 0;
+    return k_tsk_create_rt_wcet(tid, task, NULL);
+}
+
+int k_tsk_create_rt_wcet(task_t *tid, TASK_RT *task, TIMEVAL *c_n)
+{
+#ifdef DEBUG_0
+    printf("k_tsk_create_rt_wcet: tid = 0x%x, task = 0x%x, c_n = 0x%x\r\n", tid, task, c_n);
+#endif /* DEBUG_0 */
+    if (tid == NULL || task == NULL || task->task_entry == NULL ||
+        task->u_stack_size < U_STACK_SIZE || g_num_active_tasks >= MAX_TASKS) {
+        return RTX_ERR;
+    }
+    // the period is a whole number of ticks, and small enough to count in us
+    U32 qtm = g_sys_info.rtx_time_qtm;
+    if (task->p_n.sec >= 4000 || task->p_n.usec >= 1000000) {
+        return RTX_ERR;
+    }
+    U32 period_us = task->p_n.sec * 1000000 + task->p_n.usec;
+    if (period_us == 0 || period_us % qtm != 0) {
+        return RTX_ERR;
+    }
+    U32 wcet_us = RT_WCET_TICKS * qtm;
+    if (c_n != NULL) {
+        if (c_n->sec >= 4000 || c_n->usec >= 1000000) {
+            return RTX_ERR;
+        }
+        wcet_us = c_n->sec * 1000000 + c_n->usec;
+    }
+    // overload is refused here instead of showing up as missed deadlines
+    if (rt_admit(period_us, wcet_us) != RTX_OK) {
+        return RTX_ERR;
+    }
+
+    *tid = (task_t)remove_node();
+
+    RTX_TASK_INFO rtx_task_info;
+    rtx_task_info.tid = *tid;
+    rtx_task_info.prio = PRIO_RT;
+    rtx_task_info.state = READY;
+    rtx_task_info.priv = 0;
+    rtx_task_info.ptask = task->task_entry;
+    rtx_task_info.u_stack_size = (task->u_stack_size + 7) & ~7;
+    rtx_task_info.k_stack_size = K_STACK_SIZE;
+    rtx_task_info.p_n = task->p_n;
+    rtx_task_info.rt_mbx_size = task->rt_mbx_size;
+
+    TCB *p_tcb = &g_tcbs[*tid];
+    p_tcb->tid = *tid;
+    p_tcb->state = READY;
+    p_tcb->u_stack_size = rtx_task_info.u_stack_size;
+    // the first period starts at the current tick
+    p_tcb->rt_period = period_us / qtm;
+    p_tcb->rt_wcet = wcet_us;
+    p_tcb->rt_deadline = g_rtx_ticks + p_tcb->rt_period;
+    // the first release is the last tick, the time since is in HPS timer 0
+    U32 period = qtm * HPS_TIMER_MHZ;
+    U32 since = (period - timer_get_current_val(0)) / HPS_TIMER_MHZ;
+    p_tcb->rt_stats.jobs = 0;
+    p_tcb->rt_stats.misses = 0;
+    p_tcb->rt_stats.max_response = 0;
+    p_tcb->rt_stats.max_jitter = 0;
+    p_tcb->rt_stats.finish = 0;
+    p_tcb->rt_stats.release = timer_get_current_val(2) + since + period_us;
+    rt_job_release(p_tcb);
+    g_num_active_tasks++;
+
+    if (k_tsk_create_new(&rtx_task_info, p_tcb, *tid) != RTX_OK) {
+        p_tcb->rt_period = 0;
+        p_tcb->state = DORMANT;
+        g_num_active_tasks--;
+        insert_node(*tid);
+        return RTX_ERR;
+    }
+    if (task->rt_mbx_size >= MIN_MBX_SIZE) {
+        create_mailbox(task->rt_mbx_size, &p_tcb->mailbox);
+    }
+    if (g_sys_info.sched == RM_PS || g_sys_info.sched == RM_NPS) {
+        rm_assign_prio();
+    }
+
+    k_tsk_run_new();
+    return RTX_OK;
+}
+
+// a sleep is over
+static void sleep_expired(KTIMER *timer)
+{
+    TCB *task = (TCB *)timer->arg;
+
+    task->state = READY;
+    add_task(task);
+}
+
+// the next period starts, the deadline is the end of the period
+static void release_expired(KTIMER *timer)
+{
+    TCB *job = (TCB *)timer->arg;
+
+    job->rt_deadline += job->rt_period;
+    rt_job_release(job);
+    job->state = READY;
+    add_task(job);
 }
 
 void k_tsk_done_rt(void) {
 #ifdef DEBUG_0
     printf("k_tsk_done: Entering\r\n");
 #endif /* DEBUG_0 */
-    return;
+    TCB *p_tcb = gp_current_task;
+
+    if (p_tcb == NULL || p_tcb->rt_period == 0) {
+        return;
+    }
+    rt_job_finish(p_tcb);
+    remove_task(p_tcb->tid);
+    if (TICK_BEFORE(g_rtx_ticks, p_tcb->rt_deadline)) {
+        // wait for the next period, which starts at this job's deadline
+        p_tcb->state = SUSPENDED;
+        p_tcb->timer.fn = release_expired;
+        p_tcb->timer.arg = p_tcb;
+        k_timer_start(&p_tcb->timer, p_tcb->rt_deadline);
+    } else {
+        // missed the deadline, the next period has already started
+        p_tcb->rt_deadline += p_tcb->rt_period;
+        rt_job_release(p_tcb);
+        add_task(p_tcb);
+    }
+    k_tsk_run_new();
+}
+
+int k_tsk_get_rt_stats(task_t task_id, RTX_RT_STATS *buffer)
+{
+#ifdef DEBUG_0
+    printf("k_tsk_get_rt_stats: task_id = %d, buffer = 0x%x.\n\r", task_id, buffer);
+#endif /* DEBUG_0 */
+    if (buffer == NULL || task_id >= MAX_TASKS || g_tcbs[task_id].state == DORMANT ||
+        g_tcbs[task_id].rt_period == 0) {
+        return RTX_ERR;
+    }
+    *buffer = g_tcbs[task_id].rt_stats;
+    return RTX_OK;
+}
+
+int k_tsk_get_sched_hist(U8 prio, RTX_SCHED_HIST *buffer)
+{
+#ifdef DEBUG_0
+    printf("k_tsk_get_sched_hist: prio = %d, buffer = 0x%x.\n\r", prio, buffer);
+#endif /* DEBUG_0 */
+#if SCHED_HIST
+    if (buffer == NULL) {
+        return RTX_ERR;
+    }
+    *buffer = g_sched_hist[prio];
+    return RTX_OK;
+#else
+    return RTX_ERR;
+#endif
 }
 
 void k_tsk_suspend(TIMEVAL *tv)
@@ -684,7 +1407,25 @@ void k_tsk_suspend(TIMEVAL *tv)
 #ifdef DEBUG_0
     printf("k_tsk_suspend: Entering\r\n");
 #endif /* DEBUG_0 */
-    return;
+    TCB *p_tcb = gp_current_task;
+
+    if (tv == NULL || p_tcb == NULL || p_tcb->tid == TID_NULL ||
+        tv->sec >= 4000 || tv->usec >= 1000000) {
+        return;
+    }
+    // whole ticks, the sleep ends on the last one
+    U32 qtm = g_sys_info.rtx_time_qtm;
+    U32 ticks = (tv->sec * 1000000 + tv->usec + qtm - 1) / qtm;
+    if (ticks == 0) {
+        return;
+    }
+
+    remove_task(p_tcb->tid);
+    p_tcb->state = SUSPENDED;
+    p_tcb->timer.fn = sleep_expired;
+    p_tcb->timer.arg = p_tcb;
+    k_timer_start(&p_tcb->timer, g_rtx_ticks + ticks);
+    k_tsk_run_new();
 }
 
 /*
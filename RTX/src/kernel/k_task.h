@@ -54,6 +54,40 @@
 extern TCB *gp_current_task;
 extern U32 registered_commands[223];
 
+/*
+ *===========================================================================
+ *                            MACROS
+ *===========================================================================
+ */
+
+// time slice of a task in ticks of g_sys_info.rtx_time_qtm, before the
+// next ready task of the same priority preempts it
+#ifndef RR_SLICE
+#define RR_SLICE        10
+#endif
+
+// non-zero stops the tick while only the null task is ready, see k_tsk_idle
+#ifndef TICKLESS_IDLE
+#define TICKLESS_IDLE   1
+#endif
+
+// non-zero records wake-to-run latency and switch cost histograms per
+// priority, see k_tsk_get_sched_hist
+#ifndef SCHED_HIST
+#define SCHED_HIST      FALSE
+#endif
+
+// ticks of every period reserved for a real-time task created without a
+// WCET, so that the admission test still counts it under RM and EDF
+#ifndef RT_WCET_TICKS
+#define RT_WCET_TICKS   1
+#endif
+
+// HPS timer counts before the tick below which the null task does not sleep
+#ifndef TICKLESS_GUARD
+#define TICKLESS_GUARD  (10 * HPS_TIMER_MHZ)
+#endif
+
 /*
  *===========================================================================
  *                            FUNCTION PROTOTYPES
@@ -73,15 +107,21 @@ TCB *   scheduler           (void);  /* return the TCB of the next ready to run
 void    k_tsk_switch        (TCB *); /* kernel thread context switch, two stacks */
 int     k_tsk_run_new       (void);  /* kernel runs a new thread  */
 int     k_tsk_yield         (void);  /* kernel tsk_yield function */
+int     k_tsk_tick          (void);  /* timer tick, non-zero when the running task is preempted */
+void    k_tsk_idle          (void);  /* null task sleeps until the next interrupt */
 
 // Not implemented, to be done by students
 int     k_tsk_create        (task_t *task, void (*task_entry)(void), U8 prio, U16 stack_size);
 void    k_tsk_exit          (void);
 int     k_tsk_set_prio      (task_t task_id, U8 prio);
 int     k_tsk_get_info      (task_t task_id, RTX_TASK_INFO *buffer);
+int     k_tsk_get_stack_usage(task_t task_id, RTX_STK_USAGE *buffer);
 task_t  k_tsk_get_tid       (void);
 int     k_tsk_create_rt     (task_t *tid, TASK_RT *task);
+int     k_tsk_create_rt_wcet(task_t *tid, TASK_RT *task, TIMEVAL *c_n);
 void    k_tsk_done_rt       (void);
+int     k_tsk_get_rt_stats  (task_t task_id, RTX_RT_STATS *buffer);
+int     k_tsk_get_sched_hist(U8 prio, RTX_SCHED_HIST *buffer);
 void    k_tsk_suspend       (struct timeval_rt *tv);
 void    add_task            (TCB *task);
 void    remove_task         (task_t tid);
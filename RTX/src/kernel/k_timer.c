@@ -0,0 +1,231 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        k_timer.c
+ * @brief       Kernel Timeout API C Code
+ *
+ * @note        A hierarchical timing wheel. Level 0 has one slot per tick
+ *              for the next 256 ticks, each level above has 64 slots that
+ *              each cover a whole turn of the level below. Starting and
+ *              cancelling a timer is a list insert or unlink. Every 256
+ *              ticks one slot of level 1 is cascaded, its timers move down
+ *              to the slots that are now close enough, and so on up the
+ *              levels. Each timer cascades at most once per level, so a
+ *              tick costs O(1) amortized plus the timers that fire.
+ *
+ *****************************************************************************/
+
+#include "k_timer.h"
+
+/*
+ *==========================================================================
+ *                            MACROS
+ *==========================================================================
+ */
+
+#define WHEEL_L0_BITS       8
+#define WHEEL_LN_BITS       6
+#define WHEEL_L0_SIZE       (1 << WHEEL_L0_BITS)
+#define WHEEL_LN_SIZE       (1 << WHEEL_LN_BITS)
+#define WHEEL_L0_MASK       (WHEEL_L0_SIZE - 1)
+#define WHEEL_LN_MASK       (WHEEL_LN_SIZE - 1)
+#define WHEEL_LEVELS        4       /* levels above 0 included */
+
+// first tick that does not fit level n, beyond the top level is clamped
+#define WHEEL_SPAN(n)       (1U << (WHEEL_L0_BITS + (n) * WHEEL_LN_BITS))
+#define WHEEL_MAX_DELTA     (WHEEL_SPAN(WHEEL_LEVELS - 1) - 1)
+
+// slot of level n > 0 that holds the tick t
+#define WHEEL_INDEX(t, n)   (((t) >> (WHEEL_L0_BITS + ((n) - 1) * WHEEL_LN_BITS)) & WHEEL_LN_MASK)
+
+/*
+ *==========================================================================
+ *                            GLOBAL VARIABLES
+ *==========================================================================
+ */
+
+// each slot is a circular list, the slot itself is the list head
+static ktimer_link g_wheel_l0[WHEEL_L0_SIZE];
+static ktimer_link g_wheel_ln[WHEEL_LEVELS - 1][WHEEL_LN_SIZE];
+static U32 g_wheel_next;        // next tick to process
+
+/*
+ *===========================================================================
+ *                            FUNCTIONS
+ *===========================================================================
+ */
+
+static void link_init(ktimer_link *head)
+{
+    head->next = head;
+    head->prev = head;
+}
+
+static void link_append(ktimer_link *head, ktimer_link *link)
+{
+    link->next = head;
+    link->prev = head->prev;
+    head->prev->next = link;
+    head->prev = link;
+}
+
+static void link_remove(ktimer_link *link)
+{
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    link->next = NULL;
+    link->prev = NULL;
+}
+
+// move every link of from to the empty list to
+static void link_move(ktimer_link *from, ktimer_link *to)
+{
+    if (from->next == from) {
+        link_init(to);
+        return;
+    }
+    to->next = from->next;
+    to->prev = from->prev;
+    to->next->prev = to;
+    to->prev->next = to;
+    link_init(from);
+}
+
+// the slot for a timer, counted from the next tick to process
+static void wheel_insert(KTIMER *timer)
+{
+    U32 expires = timer->expires;
+    U32 delta = expires - g_wheel_next;
+    ktimer_link *slot;
+
+    if ((S32)delta < 0) {
+        // already due, fire on the next tick
+        slot = &g_wheel_l0[g_wheel_next & WHEEL_L0_MASK];
+    } else if (delta < WHEEL_SPAN(0)) {
+        slot = &g_wheel_l0[expires & WHEEL_L0_MASK];
+    } else {
+        int n = 1;
+        if (delta > WHEEL_MAX_DELTA) {
+            // parked at the far end, cascading puts it back on track
+            expires = g_wheel_next + WHEEL_MAX_DELTA;
+            delta = WHEEL_MAX_DELTA;
+        }
+        while (delta >= WHEEL_SPAN(n)) {
+            n++;
+        }
+        slot = &g_wheel_ln[n - 1][WHEEL_INDEX(expires, n)];
+    }
+    link_append(slot, &timer->link);
+}
+
+// redistribute one slot of level n, returns the slot index
+static U32 wheel_cascade(int n)
+{
+    U32 index = WHEEL_INDEX(g_wheel_next, n);
+    ktimer_link list;
+
+    link_move(&g_wheel_ln[n - 1][index], &list);
+    while (list.next != &list) {
+        ktimer_link *link = list.next;
+        link_remove(link);
+        wheel_insert((KTIMER *)link);
+    }
+    return index;
+}
+
+void k_timer_init(U32 now)
+{
+    for (int i = 0; i < WHEEL_L0_SIZE; i++) {
+        link_init(&g_wheel_l0[i]);
+    }
+    for (int n = 0; n < WHEEL_LEVELS - 1; n++) {
+        for (int i = 0; i < WHEEL_LN_SIZE; i++) {
+            link_init(&g_wheel_ln[n][i]);
+        }
+    }
+    g_wheel_next = now + 1;
+}
+
+void k_timer_start(KTIMER *timer, U32 expires)
+{
+    if (timer->link.next != NULL) {
+        link_remove(&timer->link);
+    }
+    timer->expires = expires;
+    wheel_insert(timer);
+}
+
+void k_timer_cancel(KTIMER *timer)
+{
+    if (timer->link.next != NULL) {
+        link_remove(&timer->link);
+    }
+}
+
+U32 k_timer_next(U32 limit)
+{
+    U32 index = g_wheel_next & WHEEL_L0_MASK;
+    U32 ticks = 1;
+
+    // a turn of level 0 ends with a cascade, the levels above are not searched
+    while (ticks < limit && index != 0 && g_wheel_l0[index].next == &g_wheel_l0[index]) {
+        index = (index + 1) & WHEEL_L0_MASK;
+        ticks++;
+    }
+    return ticks;
+}
+
+void k_timer_run(U32 now)
+{
+    ktimer_link list;
+
+    // catches up tick by tick if the caller fell behind
+    while ((S32)(now - g_wheel_next) >= 0) {
+        U32 index = g_wheel_next & WHEEL_L0_MASK;
+
+        // a new turn of level 0 starts, refill it from the levels above
+        if (index == 0) {
+            for (int n = 1; n < WHEEL_LEVELS && wheel_cascade(n) == 0; n++);
+        }
+        g_wheel_next++;
+
+        link_move(&g_wheel_l0[index], &list);
+        while (list.next != &list) {
+            KTIMER *timer = (KTIMER *)list.next;
+            link_remove(&timer->link);
+            timer->fn(timer);
+        }
+    }
+}
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
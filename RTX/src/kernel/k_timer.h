@@ -0,0 +1,65 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        k_timer.h
+ * @brief       Kernel Timeout API Header File
+ *
+ * @note        Timeouts are counted in ticks of HPS timer 0, one tick every
+ *              rtx_time_qtm microseconds. The caller owns the KTIMER and
+ *              sets fn and arg before starting it. fn runs from the timer
+ *              interrupt, with the timer already stopped, and may start it
+ *              again.
+ *
+ *****************************************************************************/
+
+#ifndef K_TIMER_H_
+#define K_TIMER_H_
+
+#include "k_inc.h"
+
+/*
+ *===========================================================================
+ *                            FUNCTION PROTOTYPES
+ *===========================================================================
+ */
+
+void    k_timer_init        (U32 now);          /* empty wheel, now is the last tick */
+void    k_timer_start       (KTIMER *timer, U32 expires);
+                                                /* fire at tick expires, restarts a pending timer */
+void    k_timer_cancel      (KTIMER *timer);    /* stop a timer, pending or not */
+void    k_timer_run         (U32 now);          /* fire everything due up to tick now */
+U32     k_timer_next        (U32 limit);        /* ticks until k_timer_run has work, at most limit */
+
+#endif // ! K_TIMER_H_
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
@@ -57,6 +57,7 @@ void task_null (void)
             printf("==============Task NULL===============\r\n");
         }
 #endif
+        k_tsk_idle();
         k_tsk_yield();
     }
 }
@@ -80,7 +81,10 @@ int main()
     // start the RTX and built-in tasks
     if (mode == MODE_SVC) {
         gp_current_task = NULL;
-        k_rtx_init(task_info, BOOT_TASKS);
+#if TEST == 9
+        test_mem();     // benchmarks own the heap until k_rtx_init resets it
+#endif
+        k_rtx_init_rt(&sys_info, task_info, BOOT_TASKS);
     }
 
     task_null();